@@ -0,0 +1,92 @@
+/** Benchmark of worker spawn/destroy throughput: compact workers (slab allocated) vs. async workers. */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <worker/compact.hpp>
+#include <worker/slab.hpp>
+#include <worker/worker.hpp>
+
+namespace {
+    constexpr std::size_t N_JOBS = 1'000'000;
+    constexpr std::size_t N_ASYNC_JOBS = 10'000; // thread per job is too slow for N_JOBS
+    constexpr std::size_t WAVE_SIZE = 1000; // workers alive at once
+
+    int trivial_job(const worker::yield_function_t& yield, int x) {
+        static_cast<void>(yield(1));
+        return x + 1;
+    }
+
+    /** Runs passed function & prints it's throughput (jobs per second). */
+    template<class F>
+    void measure(const char* name, std::size_t n_jobs, F f) {
+        auto start = std::chrono::steady_clock::now();
+        f(n_jobs);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << n_jobs << " jobs in " << elapsed.count() << "s ("
+                  << static_cast<double>(n_jobs) / elapsed.count() << " jobs/s)" << std::endl;
+    }
+
+    void compact_workers(std::size_t n_jobs) {
+        std::vector<worker::compact::Handle<worker::compact::compact_worker_t<decltype(&trivial_job), int>>> wave;
+        wave.reserve(WAVE_SIZE);
+        for (std::size_t i = 0; i < n_jobs; i += WAVE_SIZE) {
+            for (std::size_t j = 0; j < WAVE_SIZE; ++j) {
+                wave.push_back(worker::compact::spawn(&trivial_job, static_cast<int>(j)));
+            }
+            for (auto& worker: wave) {
+                static_cast<void>(worker->result());
+            }
+            // last references - workers are destroyed
+            wave.clear();
+        }
+    }
+
+    void async_workers(std::size_t n_jobs) {
+        std::vector<std::unique_ptr<worker::async_worker_t<decltype(&trivial_job), int>>> wave;
+        wave.reserve(WAVE_SIZE);
+        for (std::size_t i = 0; i < n_jobs; i += WAVE_SIZE) {
+            for (std::size_t j = 0; j < WAVE_SIZE; ++j) {
+                wave.push_back(worker::make_async_worker(&trivial_job, static_cast<int>(j)));
+            }
+            for (auto& worker: wave) {
+                static_cast<void>(worker->result());
+            }
+            wave.clear();
+        }
+    }
+
+    /** Allocation & deallocation of worker-sized blocks, without running workers. */
+    template<class Allocate, class Deallocate>
+    void allocations(std::size_t n_jobs, Allocate allocate, Deallocate deallocate) {
+        std::vector<void*> wave(WAVE_SIZE);
+        for (std::size_t i = 0; i < n_jobs; i += WAVE_SIZE) {
+            for (auto& block: wave) {
+                block = allocate();
+            }
+            for (auto* block: wave) {
+                deallocate(block);
+            }
+        }
+    }
+}
+
+int main() {
+    using worker_t = worker::compact::compact_worker_t<decltype(&trivial_job), int>;
+    using allocator_t = worker::slab_allocator_t<worker_t>;
+    std::cout << "compact worker size: " << sizeof(worker_t) << "B" << std::endl;
+
+    measure("slab allocator", N_JOBS, [](std::size_t n_jobs) {
+        allocations(n_jobs, &allocator_t::allocate, &allocator_t::deallocate);
+    });
+    measure("heap allocator", N_JOBS, [](std::size_t n_jobs) {
+        allocations(n_jobs, []() { return ::operator new(sizeof(worker_t)); },
+                    [](void* block) { ::operator delete(block); });
+    });
+    measure("compact workers", N_JOBS, &compact_workers);
+    measure("async workers", N_ASYNC_JOBS, &async_workers);
+
+    return 0;
+}
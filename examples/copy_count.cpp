@@ -0,0 +1,73 @@
+/** Checks that workers move (never copy) passed functions & arguments into the worker thread. */
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <worker/worker.hpp>
+
+namespace {
+    /** Counts it's copies, stands in for a large capture or argument (e.g. a vector). */
+    struct CopyCounter {
+        static inline std::size_t copies = 0;
+
+        CopyCounter() = default;
+
+        CopyCounter(const CopyCounter&) { ++copies; }
+
+        CopyCounter(CopyCounter&&) noexcept = default;
+
+        CopyCounter& operator=(const CopyCounter&) {
+            ++copies;
+            return *this;
+        }
+
+        CopyCounter& operator=(CopyCounter&&) noexcept = default;
+    };
+
+    int with_argument(const worker::yield_function_t& yield, const CopyCounter&, int x) {
+        static_cast<void>(yield(1));
+        return x;
+    }
+
+    /** Runs passed function (constructs & waits for a worker) & prints number of copies it made. */
+    template<class F>
+    bool check(const char* name, F f) {
+        CopyCounter::copies = 0;
+        f();
+        std::cout << name << ": " << CopyCounter::copies << " copies" << std::endl;
+        return CopyCounter::copies == 0;
+    }
+}
+
+int main() {
+    bool ok = true;
+    ok &= check("make_async_worker, lambda capture", []() {
+        CopyCounter counter;
+        auto worker = worker::make_async_worker([counter = std::move(counter)](const worker::yield_function_t&) {
+            return 0;
+        });
+        static_cast<void>(worker->result());
+    });
+    ok &= check("make_async_worker, argument", []() {
+        auto worker = worker::make_async_worker("argument", &with_argument, CopyCounter{}, 1);
+        static_cast<void>(worker->result());
+    });
+    ok &= check("class template argument deduction, name", []() {
+        worker::AsyncWorker worker(std::string("name"), &with_argument, CopyCounter{}, 1);
+        static_cast<void>(worker.result());
+    });
+    ok &= check("class template argument deduction, string literal name", []() {
+        worker::AsyncWorker worker("literal", &with_argument, CopyCounter{}, 1);
+        static_cast<void>(worker.result());
+    });
+    ok &= check("class template argument deduction, options", []() {
+        worker::WorkerOptions options;
+        options.name = "options";
+        worker::AsyncWorker worker(options, with_argument, CopyCounter{}, 1);
+        static_cast<void>(worker.result());
+    });
+
+    return ok ? 0 : 1;
+}
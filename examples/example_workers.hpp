@@ -9,7 +9,9 @@
 #include <thread>
 #include <sstream>
 
+#include <worker/variant_workers.hpp>
 #include <worker/worker.hpp>
+#include <worker/worker_pool.hpp>
 
 namespace worker {
     const std::vector<std::string> WORKER_EXAMPLES = {"dummy_worker", "fibonacci_slow", "selection_sort",
@@ -56,12 +58,24 @@ namespace worker {
         }
     }
 
-    /** Writes n_lines of length line_length to temporary file. */
-    void file_writer(yield_function_t yield, int n_lines, int line_length) {
+    // random generator of the worker, reused by all jobs the worker runs (e.g. fused jobs)
+    const WorkerLocal<std::mt19937> WORKER_RNG([]() {
+        std::random_device rd;
+        return std::mt19937(rd());
+    });
+
+    // phases of file_writer (write lines, then read them back)
+    const std::vector<WorkerPhase> FILE_WRITER_PHASES = {{"write", 4}, {"verify", 1}};
+
+    /**
+     * Writes n_lines of length line_length to temporary file & verifies the number of written lines.
+     * Reports progress per phase if worker has FILE_WRITER_PHASES.
+     * @return false if file doesn't contain all lines
+     */
+    bool file_writer(yield_function_t yield, int n_lines, int line_length) {
         const std::string ALPHABET = "abcdefghijklmnopqrstuvwxyz";
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
+        auto& gen = WORKER_RNG.get();
         std::uniform_int_distribution<std::size_t> alphabet_distr(0, ALPHABET.size() - 1);
 
         auto tmp_file = std::tmpfile();
@@ -79,61 +93,126 @@ namespace worker {
 
             // only yield execution every 100 lines
             if (i % 100 == 0 && !yield(static_cast<double>(i) / n_lines)) {
+                std::fclose(tmp_file);
+                return false;
+            }
+        }
+
+        this_worker::phase(1);
+        std::rewind(tmp_file);
+        int n_read = 0;
+        for (int c = std::fgetc(tmp_file); c != EOF; c = std::fgetc(tmp_file)) {
+            if (c != '\n') {
+                continue;
+            }
+            // only yield execution every 100 lines
+            if (++n_read % 100 == 0 && !yield(static_cast<double>(n_read) / n_lines)) {
                 break;
             }
         }
 
         std::fclose(tmp_file); // close & delete temporary file
+        return n_read == n_lines;
+    }
+
+    /** Sorts passed vector with selection sort and returns it (vector is moved, never copied, into the worker) */
+    std::vector<int> sort_vector(yield_function_t yield, std::vector<int> vec) {
+        selection_sort(yield, vec.begin(), vec.end());
+        return vec;
     }
 
     /**
-     * Factory function that returns random BaseWorker instances with random arguments, based on implementations in this file
+     * Samples a random function from WORKER_EXAMPLES & it's random arguments and passes them to make_worker.
+     * @param options options for the worker, it's name, size & type label are set based on the sampled function
+     *   & arguments
+     * @param make_worker constructs worker from function & arguments, must return the same type for all functions
      * @throws std::logic_error if worker that's not yet implemented in the factory is selected
      */
-    std::unique_ptr<BaseWorker> random_worker() {
+    template<class MakeWorker>
+    decltype(auto) sample_worker(WorkerOptions& options, MakeWorker make_worker) {
         // sample a random worker function from WORKER_EXAMPLES
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<std::size_t> distr(0, WORKER_EXAMPLES.size() - 1);
         std::string worker_name = WORKER_EXAMPLES[distr(gen)];
+        options.name = worker_name;
+        options.labels["type"] = worker_name;
 
         if (worker_name == "dummy_worker") {
             std::uniform_int_distribution<int> loop_n_distr(200, 1000), sleep_ms_distr(10, 100);
-            // unfortunately pointers and template deductions don't play nice
-            return std::make_unique<AsyncWorker<decltype(&dummy_worker), int, int>>(
-                    worker_name, &dummy_worker, loop_n_distr(gen), sleep_ms_distr(gen));
+            auto loop_n = loop_n_distr(gen), sleep_ms = sleep_ms_distr(gen);
+            options.size = loop_n * sleep_ms;
+            return make_worker(dummy_worker, loop_n, sleep_ms);
         }
         if (worker_name == "fibonacci_slow") {
             std::uniform_int_distribution<int> n_distr(35, 40);
-            return std::make_unique<AsyncWorker<decltype(&fibonacci_slow), int>>(
-                    worker_name, &fibonacci_slow, n_distr(gen));
+            auto n = n_distr(gen);
+            options.size = std::uint64_t(1) << n; // runtime grows exponentially
+            options.track_progress = false; // only yields for control, so progress isn't published
+            return make_worker(fibonacci_slow, n);
         }
         if (worker_name == "selection_sort") {
             std::uniform_int_distribution<std::size_t> vec_size(20000, 150000);
             std::uniform_int_distribution<int> vec_distr(-1e5, 1e5);
             std::vector<int> rand_vec(vec_size(gen));
             std::generate(rand_vec.begin(), rand_vec.end(), [&vec_distr, &gen]() { return vec_distr(gen); });
+            options.size = rand_vec.size();
 
-            // wrap selection sort with lambda that returns sorted copy
-            auto lambda =
-                    [rand_vec = std::move(rand_vec)](yield_function_t yield) mutable {
-                        selection_sort(yield, rand_vec.begin(), rand_vec.end());
-                        return rand_vec;
-                    };
-
-            return std::make_unique<AsyncWorker<decltype(lambda)>>(worker_name, lambda);
+            return make_worker(sort_vector, std::move(rand_vec));
         }
 
         if (worker_name == "file_writer") {
             std::uniform_int_distribution<int> n_lines_distr(1e5, 1e6);
             std::uniform_int_distribution<int> line_length_distr(50, 150);
-
-            return std::make_unique<AsyncWorker<decltype(&file_writer), int, int>>(
-                    worker_name, &file_writer, n_lines_distr(gen), line_length_distr(gen));
+            auto n_lines = n_lines_distr(gen), line_length = line_length_distr(gen);
+            options.size = static_cast<std::uint64_t>(n_lines) * line_length;
+            options.phases = FILE_WRITER_PHASES;
+
+            // background job, runs only when CPU would be idle otherwise (unless requested differently).
+            // Unprivileged pools skip it, since their threads couldn't leave SCHED_IDLE afterwards
+            if (options.scheduling.policy == SchedulingPolicy::INHERIT) {
+                options.scheduling = SchedulingClass::idle();
+            }
+            return make_worker(file_writer, n_lines, line_length);
         }
 
         throw std::logic_error("Unimplemented worker in random factory: " + worker_name);
     }
+
+    /**
+     * Factory function that returns random BaseWorker instances with random arguments, based on implementations in this file
+     * @param options options for created worker, it's name & size are set based on the sampled function & arguments
+     * @param pool pool that runs created worker, worker runs in it's own thread (AsyncWorker) if nullptr
+     * @throws std::logic_error if worker that's not yet implemented in the factory is selected
+     */
+    std::shared_ptr<BaseWorker> random_worker(WorkerOptions options = {}, WorkerPool* pool = nullptr) {
+        return sample_worker(options, [&options, pool](auto&& f, auto&& ... args) -> std::shared_ptr<BaseWorker> {
+            if (pool != nullptr) {
+                return make_pooled_worker(*pool, std::move(options), std::forward<decltype(f)>(f),
+                                          std::forward<decltype(args)>(args)...);
+            }
+            return make_async_worker(std::move(options), std::forward<decltype(f)>(f),
+                                     std::forward<decltype(args)>(args)...);
+        });
+    }
+
+    // container of async workers of all WORKER_EXAMPLES functions, stored inline (see VariantWorkers)
+    using example_workers_t = VariantWorkers<async_worker_t<decltype(&dummy_worker), int, int>,
+                                             async_worker_t<decltype(&fibonacci_slow), int>,
+                                             async_worker_t<decltype(&sort_vector), std::vector<int>>,
+                                             async_worker_t<decltype(&file_writer), int, int>>;
+
+    /**
+     * Same as random_worker, but constructs the async worker in passed container.
+     * @throws std::length_error if container is full
+     */
+    BaseWorker& random_worker(example_workers_t& workers, WorkerOptions options = {}) {
+        return sample_worker(options, [&options, &workers](auto&& f, auto&& ... args) -> BaseWorker& {
+            using worker_t = async_worker_t<decltype(f), decltype(args)...>;
+            return workers.template emplace<worker_t>(std::move(options), std::forward<decltype(f)>(f),
+                                                      std::forward<decltype(args)>(args)...);
+        });
+    }
 }
 
 #endif //WORKERS_MANAGER_EXAMPLE_WORKERS_HPP
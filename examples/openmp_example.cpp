@@ -0,0 +1,67 @@
+/** Workers running OpenMP parallel regions, paused, restarted & stopped as a whole team. Requires OpenMP. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <omp.h>
+
+#include <worker/openmp.hpp>
+
+namespace {
+    constexpr std::int64_t N = 20'000'000;
+    constexpr std::int64_t CHUNK = 10'000;
+
+    /** Sums square roots in a custom parallel region, every thread checks for control after each chunk. */
+    double sum_roots(const worker::yield_function_t&) {
+        worker::omp::Team team(static_cast<std::size_t>(N));
+        double sum = 0;
+
+#pragma omp parallel reduction(+:sum)
+        {
+            auto n_threads = static_cast<std::int64_t>(omp_get_num_threads());
+            for (auto first = omp_get_thread_num() * CHUNK; first < N; first += n_threads * CHUNK) {
+                auto last = std::min(N, first + CHUNK);
+                for (auto i = first; i < last; ++i) {
+                    sum += std::sqrt(static_cast<double>(i));
+                }
+                if (!team.checkpoint(static_cast<std::size_t>(last - first))) {
+                    break; // whole team skips it's remaining chunks
+                }
+            }
+        }
+        return sum;
+    }
+
+    /** Fills vector with squares using parallel_for, returns number of filled elements. */
+    std::size_t fill_squares(const worker::yield_function_t&) {
+        std::vector<double> squares(N);
+        auto done = worker::omp::parallel_for<std::int64_t>(0, N, CHUNK, [&squares](std::int64_t i) {
+            squares[i] = static_cast<double>(i) * static_cast<double>(i);
+        });
+        return done ? squares.size() : 0;
+    }
+}
+
+int main() {
+    std::cout << "OpenMP threads: " << omp_get_max_threads() << std::endl;
+
+    auto summer = worker::make_async_worker("sum_roots", &sum_roots);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    summer->pause();
+    std::cout << "sum_roots paused at " << summer->progress() * 100 << "%" << std::endl;
+    summer->restart();
+    std::cout << "sum_roots result: " << summer->result() << std::endl;
+
+    auto filler = worker::make_async_worker("fill_squares", &fill_squares);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    filler->stop();
+    std::cout << "fill_squares stopped at " << filler->progress() * 100 << "%, filled "
+              << filler->result() << " elements" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/** Benchmark of pool throughput on a mixed workload of example workers: FIFO vs. cache-aware scheduling. */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <worker/pool_schedulers.hpp>
+#include <worker/worker_pool.hpp>
+
+#include "example_workers.hpp"
+
+namespace {
+    constexpr unsigned SEED = 42; // both schedulers run the same workload
+
+    /**
+     * Submits worker of a random WORKER_EXAMPLES function (same mix as random_worker), with arguments scaled down,
+     * so the whole workload runs in seconds.
+     */
+    std::shared_ptr<worker::BaseWorker> submit_random(worker::WorkerPool& pool, std::mt19937& gen) {
+        std::uniform_int_distribution<std::size_t> distr(0, worker::WORKER_EXAMPLES.size() - 1);
+        worker::WorkerOptions options;
+        options.name = worker::WORKER_EXAMPLES[distr(gen)];
+        options.perf_counters = true; // profiles of finished workers classify types (if counters are available)
+
+        if (options.name == "dummy_worker") {
+            std::uniform_int_distribution<int> loop_n_distr(20, 50), sleep_ms_distr(1, 10);
+            auto loop_n = loop_n_distr(gen), sleep_ms = sleep_ms_distr(gen);
+            return worker::make_pooled_worker(pool, options, worker::dummy_worker, loop_n, sleep_ms);
+        }
+        if (options.name == "fibonacci_slow") {
+            std::uniform_int_distribution<int> n_distr(26, 31);
+            return worker::make_pooled_worker(pool, options, worker::fibonacci_slow, n_distr(gen));
+        }
+        if (options.name == "selection_sort") {
+            std::uniform_int_distribution<std::size_t> vec_size(5000, 20000);
+            std::uniform_int_distribution<int> vec_distr(-1e5, 1e5);
+            std::vector<int> rand_vec(vec_size(gen));
+            std::generate(rand_vec.begin(), rand_vec.end(), [&vec_distr, &gen]() { return vec_distr(gen); });
+            return worker::make_pooled_worker(pool, options, worker::sort_vector, std::move(rand_vec));
+        }
+        std::uniform_int_distribution<int> n_lines_distr(1e4, 1e5), line_length_distr(50, 150);
+        auto n_lines = n_lines_distr(gen), line_length = line_length_distr(gen);
+        return worker::make_pooled_worker(pool, options, worker::file_writer, n_lines, line_length);
+    }
+
+    /** Runs the workload on a pool with passed scheduler & prints it's throughput (workers per second). */
+    void measure(const char* name, std::size_t n_workers, std::size_t n_threads,
+                 std::unique_ptr<worker::PoolScheduler> scheduler) {
+        std::mt19937 gen(SEED);
+        auto start = std::chrono::steady_clock::now();
+        {
+            worker::WorkerPool pool(n_threads, std::move(scheduler));
+            std::vector<std::shared_ptr<worker::BaseWorker>> workers;
+            for (std::size_t i = 0; i < n_workers; ++i) {
+                workers.push_back(submit_random(pool, gen));
+            }
+            for (const auto& worker: workers) {
+                worker->wait();
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << n_workers << " workers in " << elapsed.count() << "s ("
+                  << static_cast<double>(n_workers) / elapsed.count() << " workers/s)" << std::endl;
+    }
+}
+
+/** Arguments: [number of workers (default 64)] [number of pool threads (default hardware concurrency)] */
+int main(int argc, char** argv) {
+    std::size_t n_workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    std::size_t n_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : worker::ThreadPool::default_size();
+    std::cout << "pool threads: " << n_threads << std::endl;
+
+    measure("fifo scheduler", n_workers, n_threads, std::make_unique<worker::FifoScheduler>());
+    // same profile hint as the CLI's cache scheduler, used when performance counters are unavailable
+    auto scheduler = std::make_unique<worker::CacheAwareScheduler>();
+    scheduler->set_memory_intensive("selection_sort", true);
+    measure("cache-aware scheduler", n_workers, n_threads, std::move(scheduler));
+
+    return 0;
+}
@@ -1,16 +1,49 @@
 /** CLI program that starts random workers and allows us to control them via standard input. */
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <unordered_map>
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <worker/pool_schedulers.hpp>
+#include <worker/registry.hpp>
+#include <worker/shutdown.hpp>
+#include <worker/watchdog.hpp>
+
 #include "example_workers.hpp"
 
 /** Command line options */
 struct CmdOptions {
     int n_workers{};
+    double watchdog_threshold_s{}; // 0 disables watchdog
+    bool perf_counters{};
+    bool sticky_affinity{};
+    int pool_threads{}; // 0 runs every worker in it's own thread
+    std::string scheduler;
+    int queue_capacity{}; // 0 for unbounded pool queue
+    std::string overflow;
+    double deadline_s{}; // 0 for workers without deadlines
 };
 
+// overflow policies by their command line names
+const std::map<std::string, worker::OverflowPolicy> OVERFLOW_POLICIES = {
+        {"block",       worker::OverflowPolicy::BLOCK},
+        {"reject",      worker::OverflowPolicy::REJECT},
+        {"caller-runs", worker::OverflowPolicy::CALLER_RUNS},
+        {"drop-oldest", worker::OverflowPolicy::DROP_OLDEST}};
+
+// worker statuses by their command names
+const std::map<std::string, worker::Status> STATUSES = {
+        {"running",   worker::Status::RUNNING},
+        {"paused",    worker::Status::PAUSED},
+        {"stopped",   worker::Status::STOPPED},
+        {"finished",  worker::Status::FINISHED},
+        {"suspended", worker::Status::SUSPENDED}};
+
 /**
  * Parses command line options using boost::program_options.
  * Exits the program in case of failure or if only help message should be displayed.
@@ -25,7 +58,25 @@ CmdOptions parse_cmd_options(int argc, char** argv) {
     desc.add_options()
             ("help", "prints help message")
             ("threads,t", po::value<int>(&options.n_workers)->required()->value_name("nb_threads"),
-             "number of worker threads to run (required)");
+             "number of worker threads to run (required)")
+            ("watchdog,w", po::value<double>(&options.watchdog_threshold_s)->default_value(0)->value_name("seconds"),
+             "warns about workers that haven't yielded for given number of seconds (0 disables watchdog)")
+            ("perf,p", po::bool_switch(&options.perf_counters),
+             "measures hardware performance counters of workers (see perf command)")
+            ("sticky,s", po::bool_switch(&options.sticky_affinity),
+             "resumed workers return to the CPU they paused on, if it's free")
+            ("pool", po::value<int>(&options.pool_threads)->default_value(0)->value_name("nb_threads"),
+             "runs workers on a pool with given number of threads (0 runs every worker in it's own thread)")
+            ("scheduler", po::value<std::string>(&options.scheduler)->default_value("fifo")->value_name("name"),
+             "pool scheduler: fifo, cache (limits memory intensive workers per socket), sjf (shortest remaining job "
+             "first, based on runtimes of finished workers), edf (earliest deadline first, rejects workers that "
+             "would miss their deadlines)")
+            ("deadline", po::value<double>(&options.deadline_s)->default_value(0)->value_name("seconds"),
+             "workers should finish within given number of seconds (0 for no deadlines)")
+            ("queue", po::value<int>(&options.queue_capacity)->default_value(0)->value_name("capacity"),
+             "maximum number of workers queued by the pool (0 for unbounded queue)")
+            ("overflow", po::value<std::string>(&options.overflow)->default_value("block")->value_name("policy"),
+             "what pool does with workers when it's queue is full: block, reject, caller-runs, drop-oldest");
 
     po::variables_map vm;
     try {
@@ -57,9 +108,53 @@ CmdOptions parse_cmd_options(int argc, char** argv) {
         std::exit(2);
     }
 
+    if (options.watchdog_threshold_s < 0) {
+        std::cerr << "Watchdog threshold should be a non-negative number (is " << options.watchdog_threshold_s << ")";
+        std::exit(2);
+    }
+
+    if (options.pool_threads < 0) {
+        std::cerr << "Number of pool threads should be a non-negative integer (is " << options.pool_threads << ")";
+        std::exit(2);
+    }
+    if (options.scheduler != "fifo" && options.scheduler != "cache" && options.scheduler != "sjf" &&
+        options.scheduler != "edf") {
+        std::cerr << "Unknown scheduler: " << options.scheduler;
+        std::exit(2);
+    }
+    if (options.queue_capacity < 0) {
+        std::cerr << "Queue capacity should be a non-negative integer (is " << options.queue_capacity << ")";
+        std::exit(2);
+    }
+    if (OVERFLOW_POLICIES.count(options.overflow) == 0) {
+        std::cerr << "Unknown overflow policy: " << options.overflow;
+        std::exit(2);
+    }
+    if (options.deadline_s < 0) {
+        std::cerr << "Deadline should be a non-negative number (is " << options.deadline_s << ")";
+        std::exit(2);
+    }
+
     return options;
 }
 
+/** Creates pool scheduler with passed name */
+std::unique_ptr<worker::PoolScheduler> make_scheduler(const std::string& name) {
+    if (name == "cache") {
+        auto scheduler = std::make_unique<worker::CacheAwareScheduler>();
+        // profile hint, used when performance counters are unavailable
+        scheduler->set_memory_intensive("selection_sort", true);
+        return scheduler;
+    }
+    if (name == "sjf") {
+        return std::make_unique<worker::ShortestJobScheduler>();
+    }
+    if (name == "edf") {
+        return std::make_unique<worker::DeadlineScheduler>();
+    }
+    return std::make_unique<worker::FifoScheduler>();
+}
+
 /**
  * Accepts commands for controlling workers from standard input and executes them.
  * It's mainloop may be started from a different thread.
@@ -68,7 +163,12 @@ class WorkersManagerCLI {
 public:
     /** Accepts vector of BaseWorker instances to manage */
     explicit WorkersManagerCLI(std::vector<std::shared_ptr<worker::BaseWorker>> workers) :
-            workers_(std::move(workers)) {}
+            workers_(std::move(workers)) {
+        for (std::size_t i = 0; i < workers_.size(); ++i) {
+            registry_.add(workers_[i]);
+            cli_ids_[workers_[i]->id()] = i + 1;
+        }
+    }
 
     /** Reads commands from standard input & executes them until stopped. */
     void mainloop() {
@@ -97,13 +197,101 @@ private:
     static void print_help() {
         std::cout << "Welcome to Workers Manager" << std::endl;
         std::cout << "Commands: " << std::endl;
-        std::cout << "  status - Prints id and status of all workers" << std::endl;
+        std::cout << "  status - Prints id, status, progress & phase of all workers" << std::endl;
+        std::cout << "  status --since <epoch> - Prints only workers that changed since status returned <epoch>"
+                  << std::endl;
         std::cout << "  pause <id> - Pauses worker with id <id>" << std::endl;
         std::cout << "  restart <id> - Restarts (resumes) worker with id <id>" << std::endl;
         std::cout << "  stop <id> - Stops worker with id <id>" << std::endl;
+        std::cout << "  find <label>=<value>... [status=<status>] - Prints workers with all given labels "
+                     "(e.g. type=file_writer) & status" << std::endl;
+        std::cout << "  stop-all <label>=<value>... [status=<status>] - Requests all matching workers to stop"
+                  << std::endl;
+        std::cout << "  perf - Prints performance counters & CPU migrations per worker and counters per worker type "
+                     "(counters require --perf)" << std::endl;
         std::cout << std::string(40, '-') << std::endl;
     }
 
+    /** Prints performance counters of all workers & aggregated per worker type (of done workers) */
+    void print_perf() const {
+        std::cout << "Workers performance counters (updated on pause & when done):" << std::endl;
+        for (std::size_t i = 0; i < workers_.size(); ++i) {
+            std::cout << std::setw(5) << i + 1 << " | " << std::setw(20) << workers_[i]->name() << " | "
+                      << workers_[i]->perf_sample() << ", migrations " << workers_[i]->migrations() << std::endl;
+        }
+
+        std::cout << "Performance counters per worker type:" << std::endl;
+        for (const auto&[type, sample]: worker::PerfStats::global().per_type()) {
+            std::cout << std::setw(20) << type << " | " << sample << std::endl;
+        }
+    }
+
+    /** Prints workers that changed since passed epoch (all workers for 0) & the current epoch */
+    void print_status(std::uint64_t since) {
+        auto snapshot = registry_.snapshot(since);
+        std::cout << "Workers status (epoch " << snapshot.epoch;
+        if (since > 0) {
+            std::cout << ", " << snapshot.workers.size() << " changed since " << since;
+        }
+        std::cout << "):" << std::endl;
+        for (const auto& worker: snapshot.workers) {
+            std::cout << std::setw(5) << cli_ids_.at(worker.id) << " | " << worker << std::endl;
+        }
+    }
+
+    /** Prints result of a timed worker command */
+    static void print_command_result(bool done, const std::string& action) {
+        if (done) {
+            std::cout << "Worker has been " << action << std::endl;
+        }
+        else {
+            std::cout << "Worker hasn't " << action << " within " << COMMAND_TIMEOUT.count()
+                      << "s, request is still pending" << std::endl;
+        }
+    }
+
+    /**
+     * Executes find or stop-all command
+     * @param tokenized_comand command, that's already been tokenized into words
+     */
+    void execute_query(const std::vector<std::string>& tokenized_comand) {
+        worker::labels_t labels;
+        std::optional<worker::Status> status;
+        for (std::size_t i = 1; i < tokenized_comand.size(); ++i) {
+            auto separator = tokenized_comand[i].find('=');
+            if (separator == std::string::npos) {
+                std::cout << "Arguments should be in <label>=<value> format" << std::endl;
+                return;
+            }
+            auto key = tokenized_comand[i].substr(0, separator), value = tokenized_comand[i].substr(separator + 1);
+            if (key != "status") {
+                labels[key] = value;
+            }
+            else if (STATUSES.count(value) > 0) {
+                status = STATUSES.at(value);
+            }
+            else {
+                std::cout << "Unknown status: " << value << std::endl;
+                return;
+            }
+        }
+
+        auto matching = registry_.find(labels, status);
+        if (tokenized_comand[0] == "stop-all") {
+            std::size_t n_stopped = 0;
+            for (const auto& worker: matching) {
+                n_stopped += worker->request_stop();
+            }
+            std::cout << "Requested " << n_stopped << " workers to stop" << std::endl;
+            return;
+        }
+
+        std::cout << "Matching workers (" << matching.size() << "):" << std::endl;
+        for (const auto& worker: matching) {
+            std::cout << std::setw(5) << cli_ids_.at(worker->id()) << " | " << *worker << std::endl;
+        }
+    }
+
     /**
      * Parses and executes a single command
      * @param tokenized_comand command, that's already been tokenized into words
@@ -115,12 +303,36 @@ private:
 
         const auto& main_command = tokenized_comand[0];
 
+        if (main_command == "find" || main_command == "stop-all") { // commands with label arguments
+            execute_query(tokenized_comand);
+            return;
+        }
+
+        if (main_command == "status" && tokenized_comand.size() == 3 && tokenized_comand[1] == "--since") {
+            // stoull alone would accept a sign (wrapping "-1" around) & trailing garbage
+            const auto& epoch = tokenized_comand[2];
+            bool is_number = !epoch.empty() && std::all_of(epoch.begin(), epoch.end(), [](unsigned char c) {
+                return std::isdigit(c) != 0;
+            });
+            try {
+                if (!is_number) {
+                    throw std::invalid_argument("Not a non-negative number");
+                }
+                print_status(std::stoull(epoch));
+            }
+            catch (const std::logic_error&) {
+                std::cout << "Epoch should be a non-negative number" << std::endl;
+            }
+            return;
+        }
+
         if (tokenized_comand.size() == 1) { // commands without arguments
             if (main_command == "status") {
-                std::cout << "Workers status:" << std::endl;
-                for (std::size_t i = 0; i < workers_.size(); ++i) {
-                    std::cout << std::setw(5) << i + 1 << " | " << *workers_[i] << std::endl;
-                }
+                print_status(0);
+                return;
+            }
+            if (main_command == "perf") {
+                print_perf();
                 return;
             }
         }
@@ -133,19 +345,17 @@ private:
 
                 auto& worker = workers_.at(id - 1); // ids start with 1
 
+                // commands wait for the worker with a timeout, so unresponsive workers can't block the CLI
                 if (main_command == "pause") {
-                    worker->pause();
-                    std::cout << "Worker has been paused" << std::endl;
+                    print_command_result(worker->pause_for(COMMAND_TIMEOUT), "paused");
                     return;
                 }
                 else if (main_command == "restart") {
-                    worker->restart();
-                    std::cout << "Worker has been restarted" << std::endl;
+                    print_command_result(worker->restart_for(COMMAND_TIMEOUT), "restarted");
                     return;
                 }
                 else if (main_command == "stop") {
-                    worker->stop();
-                    std::cout << "Worker has been stopped" << std::endl;
+                    print_command_result(worker->stop_for(COMMAND_TIMEOUT), "stopped");
                     return;
                 }
             }
@@ -165,26 +375,94 @@ private:
         std::cout << "Unrecognized command format" << std::endl;
     }
 
+    // maximum time commands wait for worker to respond
+    static constexpr std::chrono::seconds COMMAND_TIMEOUT{5};
+
     std::atomic<bool> stop_ = false;
     std::vector<std::shared_ptr<worker::BaseWorker>> workers_;
+    worker::WorkerRegistry registry_; // label index & change epochs of the workers
+    std::unordered_map<worker::worker_id_t, std::size_t> cli_ids_; // CLI ids (1-based indices) of workers
 };
 
+// how often main thread checks for shutdown signal while waiting for workers
+constexpr std::chrono::milliseconds SHUTDOWN_POLL_INTERVAL{100};
+// how long workers have to stop on shutdown
+constexpr std::chrono::seconds SHUTDOWN_TIMEOUT{5};
+
 int main(int argc, char** argv) {
     auto options = parse_cmd_options(argc, argv);
 
+    // optional pool that runs the workers
+    std::unique_ptr<worker::WorkerPool> pool;
+    worker::DeadlineScheduler* edf = nullptr; // deadline metrics are printed at the end
+    if (options.pool_threads > 0) {
+        worker::PoolOptions pool_options;
+        pool_options.n_threads = options.pool_threads;
+        pool_options.queue_capacity = options.queue_capacity;
+        pool_options.overflow = OVERFLOW_POLICIES.at(options.overflow);
+        auto scheduler = make_scheduler(options.scheduler);
+        edf = dynamic_cast<worker::DeadlineScheduler*>(scheduler.get());
+        pool = std::make_unique<worker::WorkerPool>(pool_options, std::move(scheduler));
+    }
+
     // vector of random workers
-    std::vector<std::shared_ptr<worker::BaseWorker>> workers(options.n_workers);
-    std::generate(workers.begin(), workers.end(), &worker::random_worker);
+    std::vector<std::shared_ptr<worker::BaseWorker>> workers;
+    worker::WorkerOptions worker_options;
+    worker_options.perf_counters = options.perf_counters;
+    worker_options.sticky_affinity = options.sticky_affinity;
+    for (int i = 0; i < options.n_workers; ++i) {
+        if (options.deadline_s > 0) {
+            worker_options.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<
+                    std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.deadline_s));
+        }
+        try {
+            workers.push_back(worker::random_worker(worker_options, pool.get()));
+        }
+        catch (const worker::WorkerRejected& e) {
+            std::cout << "Worker not started, " << e.what() << std::endl;
+        }
+    }
+
+    // optional watchdog that warns about stalled workers
+    std::optional<worker::Watchdog> watchdog;
+    if (options.watchdog_threshold_s > 0) {
+        watchdog.emplace(std::chrono::duration_cast<worker::Watchdog::clock_t::duration>(
+                std::chrono::duration<double>(options.watchdog_threshold_s)));
+        for (const auto& worker: workers) {
+            watchdog->watch(worker);
+        }
+    }
 
     // run worker manager cli in a separate thread
     WorkersManagerCLI workers_manager(workers);
     std::thread worker_manager_thread(&WorkersManagerCLI::mainloop, &workers_manager);
 
-    // wait for all workers to finish/stop
-    for (const auto& worker: workers) {
-        worker->wait();
+    // wait for all workers to finish/stop or for the shutdown signal (SIGINT/SIGTERM)
+    worker::ShutdownSignal::install();
+    while (!worker::wait_all_until(workers, std::chrono::steady_clock::now() + SHUTDOWN_POLL_INTERVAL).empty()) {
+        if (!worker::ShutdownSignal::triggered()) {
+            continue;
+        }
+
+        std::cout << std::endl << "Shutting down workers..." << std::endl;
+        auto report = worker::shutdown(workers, std::chrono::steady_clock::now() + SHUTDOWN_TIMEOUT);
+        for (const auto& straggler: report.stragglers) {
+            std::cout << "Worker " << straggler->name() << " didn't stop in time" << std::endl;
+        }
+        std::cout.flush();
+
+        // CLI thread is blocked on standard input, so the process is exited without waiting for it.
+        // Stragglers can't be destroyed (or even safely outlive static destructors), so they're abandoned.
+        if (!report.clean()) {
+            std::_Exit(1);
+        }
+        std::exit(0);
     }
     std::cout << std::endl << "All workers stopped or finished" << std::endl;
+    if (edf != nullptr) {
+        std::cout << "Deadlines: " << edf->deadlines_met() << " met, " << edf->deadline_misses() << " missed, "
+                  << edf->n_rejected() << " workers rejected" << std::endl;
+    }
 
     // finally, wait for workers manager CLI to stop
     workers_manager.stop();
@@ -0,0 +1,68 @@
+/** Benchmark of yield overhead on fibonacci: progress publishing yields vs. control-only checks. */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include <worker/compact.hpp>
+#include <worker/worker.hpp>
+
+namespace {
+    constexpr int N = 32;
+
+    /** Same as fibonacci_slow (example_workers.hpp), checks for control with yield(0). */
+    std::uint64_t fibonacci_yield(const worker::yield_function_t& yield, int n) {
+        if (n < 2) {
+            return n;
+        }
+        if (!yield(0)) {
+            return -1;
+        }
+        return fibonacci_yield(yield, n - 1) + fibonacci_yield(yield, n - 2);
+    }
+
+    /** Same as above, checks for control with this_worker::should_continue (no progress is published). */
+    std::uint64_t fibonacci_control(int n) {
+        if (n < 2) {
+            return n;
+        }
+        if (!worker::this_worker::should_continue()) {
+            return -1;
+        }
+        return fibonacci_control(n - 1) + fibonacci_control(n - 2);
+    }
+
+    /** Calls passed function (returns worker's result) & prints it's runtime. */
+    template<class F>
+    void measure(const char* name, F f) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << elapsed.count() << "s (fib(" << N << ") = " << result << ")" << std::endl;
+    }
+}
+
+int main() {
+    measure("async worker, yield", []() {
+        return worker::make_async_worker(&fibonacci_yield, N)->result();
+    });
+    measure("async worker without progress tracking, yield", []() {
+        worker::WorkerOptions options;
+        options.track_progress = false;
+        return worker::make_async_worker(options, &fibonacci_yield, N)->result();
+    });
+    measure("async worker, should_continue", []() {
+        return worker::make_async_worker([](const worker::yield_function_t&) { return fibonacci_control(N); })
+                ->result();
+    });
+    measure("compact worker, yield", []() {
+        return worker::compact::spawn(&fibonacci_yield, N)->result();
+    });
+    measure("compact worker without progress, yield", []() {
+        using block_t = worker::compact::BasicControlBlock<worker::compact::ParkingLotSync,
+                worker::compact::NoProgress>;
+        return worker::compact::spawn<block_t>(&fibonacci_yield, N)->result();
+    });
+
+    return 0;
+}
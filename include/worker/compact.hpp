@@ -0,0 +1,461 @@
+/**
+ * Compact workers: 16-byte control block (packed atomic state, progress & intrusive reference count) that's
+ * referenced through lightweight handles. Meant for large numbers of small workers that run on a thread pool.
+ * Control block's internals are configured with compile-time policies (see compact_policies.hpp).
+ */
+
+#ifndef WORKERS_MANAGER_COMPACT_HPP
+#define WORKERS_MANAGER_COMPACT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <worker/compact_policies.hpp>
+#include <worker/slab.hpp>
+#include <worker/thread_pool.hpp>
+#include <worker/worker.hpp>
+
+namespace worker::compact {
+    template<class T>
+    class Handle;
+
+    /**
+     * Abstract worker control block that can be paused, restarted and stopped (see BaseWorker).
+     * Status & requested status change are packed in a single atomic and references are counted intrusively
+     * (see Handle). Workers have no name or id - the address of the control block identifies them.
+     * Internals are compile-time policies, with defaults the block takes 16 bytes:
+     * @tparam Sync how threads wait (ParkingLotSync by default, SpinSync)
+     * @tparam Progress how progress is stored (FixedProgress by default, DoubleProgress, NoProgress)
+     * @tparam Instrumentation what's measured (NoInstrumentation by default, CountingInstrumentation,
+     *   HistogramInstrumentation), it's getters are available on the block
+     */
+    template<class Sync = ParkingLotSync, class Progress = FixedProgress, class Instrumentation = NoInstrumentation>
+    class BasicControlBlock : public Instrumentation {
+    public:
+        // non-copyable
+        BasicControlBlock(const BasicControlBlock& other) = delete;
+
+        BasicControlBlock& operator=(const BasicControlBlock& other) = delete;
+
+        /** Returns worker status (e.g. running, paused, ...). Lock-free. */
+        [[nodiscard]] Status status() const noexcept { return status_of(state_.load(std::memory_order_acquire)); }
+
+        /** Returns worker's progress, in the 0-1 range (0%-100%). Untracked progress is 0 until worker finishes. */
+        [[nodiscard]] double progress() const noexcept {
+            if constexpr(Progress::TRACKED) {
+                return progress_.load();
+            }
+            else {
+                return status() == Status::FINISHED ? 1 : 0;
+            }
+        }
+
+        /**
+         * Pauses worker (blocking call)
+         * @throws std::logic_error if worker is not running when the method is called
+         */
+        void pause() { change_status(Status::PAUSED); }
+
+        /**
+         * Restarts (resumes) worker (blocking call)
+         * @throws std::logic_error if worker is not paused when the method is called
+         */
+        void restart() { change_status(Status::RUNNING); }
+
+        /**
+         * Stops worker (blocking call). Worker can't be restarted after it is stopped
+         * @throws std::logic_error if worker has already finished it's work
+         */
+        void stop() { change_status(Status::STOPPED); }
+
+        /**
+         * Requests worker to stop without waiting for it (non-blocking).
+         * @return false if worker has already finished/stopped
+         */
+        bool request_stop() noexcept;
+
+        /** Waits for worker to finish/stop. Thread-safe. */
+        void wait() const {
+            Sync::park(this, [this]() { return terminal(status()); });
+        }
+
+    protected:
+        BasicControlBlock() = default;
+
+        /** Control block is destroyed through the last handle. */
+        virtual ~BasicControlBlock() = default;
+
+        /** Needs to be called by implementations on the thread that runs the worker, before running it. */
+        void worker_started() noexcept { Instrumentation::on_start(); }
+
+        /**
+         * Must be called by the running worker when it can yield control of execution (see BaseWorker::yield).
+         * Fast path (no pending status change) is a progress store & a single relaxed atomic load, without progress
+         * & instrumentation (NoProgress, NoInstrumentation) only the load remains.
+         * @return boolean indicating whether the worker should continue running (true) or cleanly stop (false)
+         */
+        [[nodiscard]] bool yield(double progress);
+
+        /** Needs to be called by implementations when worker is done (finished or stopped). */
+        void worker_done() noexcept;
+
+    private:
+        template<class T>
+        friend class Handle;
+
+        // state layout: status in bits 0-1, requested status change in bits 2-3
+        static Status status_of(std::uint16_t state) noexcept { return static_cast<Status>(state & 0x3u); }
+
+        static Status change_of(std::uint16_t state) noexcept { return static_cast<Status>((state >> 2) & 0x3u); }
+
+        static std::uint16_t make_state(Status status, Status change) noexcept {
+            return static_cast<std::uint16_t>(static_cast<unsigned>(status) | static_cast<unsigned>(change) << 2);
+        }
+
+        static bool terminal(Status status) noexcept { return status == Status::STOPPED || status == Status::FINISHED; }
+
+        /** Sets worker's status, keeping requested change. Wakes waiters. */
+        void set_status(Status status) noexcept;
+
+        /**
+         * Validates & schedules status change, then waits for it to happen (or for worker to finish/stop).
+         * @throws std::logic_error if current status doesn't allow requested change
+         */
+        void change_status(Status change);
+
+        void add_ref() noexcept { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+        void release() noexcept {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+        std::atomic<std::uint32_t> refs_ = 0; // number of handles referencing the block
+        std::atomic<std::uint16_t> state_ = make_state(Status::RUNNING, Status::RUNNING);
+        Progress progress_; // last, so untracked progress fits into padding
+    };
+
+    // control block with default policies
+    using ControlBlock = BasicControlBlock<>;
+
+    static_assert(sizeof(void*) != 8 || sizeof(ControlBlock) == 16, "control block should be 16 bytes");
+    static_assert(sizeof(void*) != 8 || sizeof(BasicControlBlock<ParkingLotSync, NoProgress>) == 16,
+                  "control block without progress should be 16 bytes");
+
+    /**
+     * Intrusive reference to a control block (single pointer). Copies share the block, which is destroyed
+     * with the last reference. Handle can be converted to a handle of control block's base class.
+     * @tparam T control block type
+     */
+    template<class T>
+    class Handle {
+    public:
+        Handle() = default;
+
+        Handle(const Handle& other) noexcept: Handle(other.worker_) {}
+
+        Handle(Handle&& other) noexcept: worker_(other.detach()) {}
+
+        template<class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+        Handle(const Handle<U>& other) noexcept: Handle(other.get()) {}
+
+        ~Handle() { reset(); }
+
+        Handle& operator=(Handle other) noexcept {
+            std::swap(worker_, other.worker_);
+            return *this;
+        }
+
+        /** Takes over a reference that was previously detached from a handle. */
+        static Handle adopt(T* worker) noexcept {
+            Handle handle;
+            handle.worker_ = worker;
+            return handle;
+        }
+
+        /** Releases ownership of the reference without decrementing the count (see adopt). */
+        T* detach() noexcept { return std::exchange(worker_, nullptr); }
+
+        /** Drops the reference. */
+        void reset() noexcept {
+            if (worker_ != nullptr) {
+                std::exchange(worker_, nullptr)->release();
+            }
+        }
+
+        [[nodiscard]] T* get() const noexcept { return worker_; }
+
+        T& operator*() const noexcept { return *worker_; }
+
+        T* operator->() const noexcept { return worker_; }
+
+        explicit operator bool() const noexcept { return worker_ != nullptr; }
+
+    private:
+        template<class Block, class Function, class... Args>
+        friend class BasicCompactWorker;
+
+        /** References passed control block (increments the count). */
+        explicit Handle(T* worker) noexcept: worker_(worker) {
+            if (worker_ != nullptr) {
+                worker_->add_ref();
+            }
+        }
+
+        T* worker_ = nullptr;
+    };
+
+    /**
+     * Compact worker that runs passed function with arguments & stores it's result (see AsyncWorker).
+     * Constructed & started with spawn. Control block, task & result slot are a single allocation from the
+     * per-thread slabs (see SlabAllocator), so spawning & destroying workers doesn't call malloc in steady state.
+     * @tparam Block control block type (BasicControlBlock with chosen policies)
+     */
+    template<class Block, class Function, class... Args>
+    class BasicCompactWorker final : public Block {
+        using function_return_t = std::invoke_result_t<Function&, yield_function_t, Args...>;
+
+    public:
+        /** Constructs (but doesn't run) worker from passed function & arguments. */
+        template<class F, class... FArgs>
+        explicit BasicCompactWorker(F&& f, FArgs&& ... args)
+                : task_(std::forward<F>(f), std::forward<FArgs>(args)...) {}
+
+        /**
+         * Returns worker's result. Blocks until the result is available (worker finished or stopped).
+         * Result can only be obtained once.
+         * @throws std::logic_error if result was already obtained
+         * @throws any exception thrown by worker's function
+         */
+        function_return_t result();
+
+        /** Runs the worker on the calling thread. Called once (see spawn). */
+        void run() noexcept;
+
+        /** Returns handle referencing passed worker (e.g. from a pointer taken by a handle's user). */
+        static Handle<BasicCompactWorker> handle(BasicCompactWorker* worker) noexcept {
+            return Handle<BasicCompactWorker>(worker);
+        }
+
+        /** Allocates worker from the slabs (large or over-aligned workers from the heap). */
+        static void* operator new(std::size_t size);
+
+        static void operator delete(void* worker) noexcept;
+
+    private:
+        struct Void {
+        };
+        using stored_t = std::conditional_t<std::is_void_v<function_return_t>, Void, function_return_t>;
+
+        std::tuple<Function, Args...> task_;
+        std::variant<std::monostate, stored_t, std::exception_ptr> result_; // empty until done or once obtained
+    };
+
+    /** Compact worker with the default control block policies. */
+    template<class Function, class... Args>
+    using CompactWorker = BasicCompactWorker<ControlBlock, Function, Args...>;
+
+    /** BasicCompactWorker type that spawn<Block> constructs for the passed function & arguments. */
+    template<class Block, class F, class... FArgs>
+    using basic_compact_worker_t = BasicCompactWorker<Block, std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    /** CompactWorker type that spawn constructs for the passed function & arguments. */
+    template<class F, class... FArgs>
+    using compact_worker_t = basic_compact_worker_t<ControlBlock, F, FArgs...>;
+
+    /**
+     * Constructs compact worker & queues it on passed thread pool. Function & arguments are perfectly forwarded.
+     * Pool threads are occupied by paused workers.
+     * @tparam Block control block type, e.g. spawn<BasicControlBlock<SpinSync, NoProgress>>(pool, f, args...)
+     */
+    template<class Block = ControlBlock, class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>&, yield_function_t, std::decay_t<FArgs>...>>>
+    Handle<basic_compact_worker_t<Block, F, FArgs...>> spawn(ThreadPool& pool, F&& f, FArgs&& ... args) {
+        using worker_t = basic_compact_worker_t<Block, F, FArgs...>;
+        auto worker = worker_t::handle(new worker_t(std::forward<F>(f), std::forward<FArgs>(args)...));
+
+        // queued task owns a reference (raw pointer keeps the task small enough to avoid allocation)
+        auto task_ref = worker;
+        pool.submit([task = task_ref.detach()]() {
+            auto task_worker = Handle<worker_t>::adopt(task);
+            task_worker->run();
+        });
+        return worker;
+    }
+
+    /** Same as above, on the default thread pool. */
+    template<class Block = ControlBlock, class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>&, yield_function_t, std::decay_t<FArgs>...>>>
+    Handle<basic_compact_worker_t<Block, F, FArgs...>> spawn(F&& f, FArgs&& ... args) {
+        return spawn<Block>(ThreadPool::default_pool(), std::forward<F>(f), std::forward<FArgs>(args)...);
+    }
+
+
+    // ******* Implementations ********************************************
+    template<class Sync, class Progress, class Instrumentation>
+    bool BasicControlBlock<Sync, Progress, Instrumentation>::request_stop() noexcept {
+        auto state = state_.load(std::memory_order_relaxed);
+        do {
+            if (terminal(status_of(state))) {
+                return false;
+            }
+        } while (!state_.compare_exchange_weak(state, make_state(status_of(state), Status::STOPPED),
+                                               std::memory_order_acq_rel));
+
+        // wake potentially paused worker
+        Sync::unpark_all(this);
+        return true;
+    }
+
+    template<class Sync, class Progress, class Instrumentation>
+    bool BasicControlBlock<Sync, Progress, Instrumentation>::yield(double progress) {
+        progress_.store(progress);
+        Instrumentation::on_yield();
+
+        // fast path - no status change was requested (requests don't publish any data, so no ordering is needed)
+        auto change = change_of(state_.load(std::memory_order_relaxed));
+        if (change == Status::RUNNING) {
+            return true;
+        }
+        if (change == Status::STOPPED) {
+            return false;
+        }
+
+        Instrumentation::on_pause();
+        set_status(Status::PAUSED);
+        // sleep until restart or stop is requested
+        Sync::park(this, [this]() { return change_of(state_.load()) != Status::PAUSED; });
+        set_status(Status::RUNNING);
+        Instrumentation::on_resume();
+
+        return change_of(state_.load(std::memory_order_acquire)) != Status::STOPPED;
+    }
+
+    template<class Sync, class Progress, class Instrumentation>
+    void BasicControlBlock<Sync, Progress, Instrumentation>::worker_done() noexcept {
+        auto state = state_.load(std::memory_order_relaxed);
+        auto status = change_of(state) == Status::STOPPED ? Status::STOPPED : Status::FINISHED;
+        if (status == Status::FINISHED) {
+            progress_.store(1);
+        }
+        set_status(status);
+    }
+
+    template<class Sync, class Progress, class Instrumentation>
+    void BasicControlBlock<Sync, Progress, Instrumentation>::set_status(Status status) noexcept {
+        auto state = state_.load(std::memory_order_relaxed);
+        while (!state_.compare_exchange_weak(state, make_state(status, change_of(state)), std::memory_order_acq_rel)) {
+        }
+        Sync::unpark_all(this);
+    }
+
+    template<class Sync, class Progress, class Instrumentation>
+    void BasicControlBlock<Sync, Progress, Instrumentation>::change_status(Status change) {
+        auto state = state_.load(std::memory_order_relaxed);
+        do {
+            auto status = status_of(state);
+            switch (change) {
+                case Status::PAUSED:
+                    if (status != Status::RUNNING) {
+                        throw std::logic_error("Worker must be running to preform pause action");
+                    }
+                    break;
+                case Status::RUNNING:
+                    if (status != Status::PAUSED) {
+                        throw std::logic_error("Worker must be paused to preform restart action");
+                    }
+                    break;
+                case Status::STOPPED:
+                    if (status != Status::RUNNING && status != Status::PAUSED) {
+                        throw std::logic_error("Worker must be running or paused to preform stop action");
+                    }
+                    break;
+                case Status::FINISHED:
+                    throw std::logic_error("Worker can't be requested to finish");
+            }
+        } while (!state_.compare_exchange_weak(state, make_state(status_of(state), change),
+                                               std::memory_order_acq_rel));
+
+        // wake potentially paused worker & wait for the change (worker can always finish/stop instead)
+        Sync::unpark_all(this);
+        Sync::park(this, [this, change]() {
+            auto status = this->status();
+            return status == change || terminal(status);
+        });
+    }
+
+    template<class Block, class Function, class... Args>
+    void BasicCompactWorker<Block, Function, Args...>::run() noexcept {
+        // yield function that's to be passed to worker function (small enough to avoid allocation)
+        yield_function_t yield_func = [this](double progress) { return this->yield(progress); };
+        auto invoke = [&yield_func](Function& f, Args& ... args) -> function_return_t {
+            return f(yield_func, std::move(args)...);
+        };
+
+        this->worker_started();
+        try {
+            if constexpr(std::is_void_v<function_return_t>) {
+                std::apply(invoke, task_);
+                result_.template emplace<1>();
+            }
+            else {
+                result_.template emplace<1>(std::apply(invoke, task_));
+            }
+        }
+        catch (...) {
+            result_.template emplace<2>(std::current_exception());
+        }
+        // result is published by the status change
+        this->worker_done();
+    }
+
+    template<class Block, class Function, class... Args>
+    void* BasicCompactWorker<Block, Function, Args...>::operator new(std::size_t size) {
+        if constexpr(slab_allocatable_v<BasicCompactWorker>) {
+            return slab_allocator_t<BasicCompactWorker>::allocate();
+        }
+        else {
+            return ::operator new(size);
+        }
+    }
+
+    template<class Block, class Function, class... Args>
+    void BasicCompactWorker<Block, Function, Args...>::operator delete(void* worker) noexcept {
+        if constexpr(slab_allocatable_v<BasicCompactWorker>) {
+            slab_allocator_t<BasicCompactWorker>::deallocate(worker);
+        }
+        else {
+            ::operator delete(worker);
+        }
+    }
+
+    template<class Block, class Function, class... Args>
+    typename BasicCompactWorker<Block, Function, Args...>::function_return_t
+    BasicCompactWorker<Block, Function, Args...>::result() {
+        this->wait();
+        if (result_.index() == 0) {
+            throw std::logic_error("Result was already obtained");
+        }
+        if (result_.index() == 2) {
+            auto exception = std::get<2>(std::exchange(result_, std::monostate()));
+            std::rethrow_exception(exception);
+        }
+
+        if constexpr(std::is_void_v<function_return_t>) {
+            result_ = std::monostate();
+        }
+        else {
+            return std::get<1>(std::exchange(result_, std::monostate()));
+        }
+    }
+}
+
+#endif //WORKERS_MANAGER_COMPACT_HPP
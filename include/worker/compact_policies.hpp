@@ -0,0 +1,217 @@
+/**
+ * Compile-time policies of compact control blocks (see BasicControlBlock): synchronization strategy, progress
+ * representation & instrumentation. Each deployment only pays for the policies it uses.
+ */
+
+#ifndef WORKERS_MANAGER_COMPACT_POLICIES_HPP
+#define WORKERS_MANAGER_COMPACT_POLICIES_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace worker::compact {
+    namespace detail {
+        /**
+         * Process-wide set of striped mutexes & condition variables, so control blocks don't need their own.
+         * Threads wait on (park) & are notified through (unpark) an address, which selects the stripe.
+         * Waiting threads of other addresses of the same stripe wake up spuriously & recheck their condition.
+         */
+        class ParkingLot {
+        public:
+            /** Blocks calling thread until passed condition is satisfied (rechecked after every unpark). */
+            template<class Predicate>
+            static void park(const void* address, Predicate ready) {
+                auto& stripe = stripe_of(address);
+                std::unique_lock<std::mutex> lock(stripe.m);
+                stripe.cv.wait(lock, ready);
+            }
+
+            /** Wakes all threads parked on passed address (call after condition changed). */
+            static void unpark_all(const void* address) {
+                auto& stripe = stripe_of(address);
+                // condition changed before the lock, so waiters can't miss the notification
+                { std::lock_guard<std::mutex> lock(stripe.m); }
+                stripe.cv.notify_all();
+            }
+
+        private:
+            static constexpr std::size_t N_STRIPES = 64;
+
+            struct Stripe {
+                std::mutex m;
+                std::condition_variable cv;
+            };
+
+            static Stripe& stripe_of(const void* address) {
+                static Stripe stripes[N_STRIPES];
+                return stripes[(reinterpret_cast<std::uintptr_t>(address) >> 4) % N_STRIPES];
+            }
+        };
+    }
+
+    /*
+     * Synchronization policies: how paused workers & threads waiting for status changes block.
+     * Provide static park(address, predicate) & unpark_all(address).
+     */
+
+    /** Waiting threads sleep on shared striped mutexes & condition variables (default). */
+    using ParkingLotSync = detail::ParkingLot;
+
+    /**
+     * Waiting threads spin (yielding their time slice) - lowest wake latency, but paused workers & waiters
+     * occupy their CPUs. Meant for short pauses on dedicated cores.
+     */
+    struct SpinSync {
+        template<class Predicate>
+        static void park(const void*, Predicate ready) {
+            while (!ready()) {
+                std::this_thread::yield();
+            }
+        }
+
+        static void unpark_all(const void*) noexcept {}
+    };
+
+    /*
+     * Progress policies: how worker's progress is stored.
+     * Provide store(progress) & load() (both lock-free) and TRACKED flag.
+     */
+
+    /** 16-bit fixed point progress (default). */
+    class FixedProgress {
+    public:
+        static constexpr bool TRACKED = true;
+
+        void store(double progress) noexcept {
+            progress_.store(static_cast<std::uint16_t>(std::clamp(progress, 0., 1.) * MAX_PROGRESS),
+                            std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] double load() const noexcept {
+            return progress_.load(std::memory_order_relaxed) / static_cast<double>(MAX_PROGRESS);
+        }
+
+    private:
+        static constexpr std::uint16_t MAX_PROGRESS = UINT16_MAX;
+
+        std::atomic<std::uint16_t> progress_ = 0; // in 1/MAX_PROGRESS units
+    };
+
+    /** Full precision progress (control block grows by 8 bytes). */
+    class DoubleProgress {
+    public:
+        static constexpr bool TRACKED = true;
+
+        void store(double progress) noexcept { progress_.store(std::clamp(progress, 0., 1.), std::memory_order_relaxed); }
+
+        [[nodiscard]] double load() const noexcept { return progress_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> progress_ = 0;
+    };
+
+    /** Progress isn't tracked - yields don't write anything (worker reports 0% until it finishes). */
+    class NoProgress {
+    public:
+        static constexpr bool TRACKED = false;
+
+        void store(double) noexcept {}
+
+        [[nodiscard]] double load() const noexcept { return 0; }
+    };
+
+    /*
+     * Instrumentation policies: what's measured about worker's execution. Control blocks inherit from them,
+     * so their getters are available on workers. Hooks are called on the thread that runs the worker.
+     */
+
+    /** Nothing is measured (default). */
+    class NoInstrumentation {
+    protected:
+        void on_start() noexcept {}
+
+        void on_yield() noexcept {}
+
+        void on_pause() noexcept {}
+
+        void on_resume() noexcept {}
+    };
+
+    /** Counts yields & pauses. */
+    class CountingInstrumentation {
+    public:
+        /** Returns number of worker's yields. Lock-free. */
+        [[nodiscard]] std::uint64_t yield_count() const noexcept { return yields_.load(std::memory_order_relaxed); }
+
+        /** Returns number of times worker paused. Lock-free. */
+        [[nodiscard]] std::uint64_t pause_count() const noexcept { return pauses_.load(std::memory_order_relaxed); }
+
+    protected:
+        void on_start() noexcept {}
+
+        // only the worker's thread writes, so counters are incremented without RMW
+        void on_yield() noexcept { yields_.store(yields_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        void on_pause() noexcept { pauses_.store(pauses_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        void on_resume() noexcept {}
+
+    private:
+        std::atomic<std::uint64_t> yields_ = 0;
+        std::atomic<std::uint64_t> pauses_ = 0;
+    };
+
+    /**
+     * Counts yields & pauses and measures histogram of intervals between yields (excluding paused time),
+     * which shows whether worker yields often enough to be responsive without paying too much for it.
+     */
+    class HistogramInstrumentation : public CountingInstrumentation {
+    public:
+        // bucket i counts intervals in the [2^i, 2^(i+1)) nanoseconds range (bucket 0 also counts shorter ones)
+        static constexpr std::size_t N_BUCKETS = 40;
+
+        /** Returns histogram of intervals between yields. Lock-free (buckets are read one by one). */
+        [[nodiscard]] std::array<std::uint64_t, N_BUCKETS> yield_intervals() const noexcept {
+            std::array<std::uint64_t, N_BUCKETS> histogram{};
+            for (std::size_t i = 0; i < N_BUCKETS; ++i) {
+                histogram[i] = buckets_[i].load(std::memory_order_relaxed);
+            }
+            return histogram;
+        }
+
+    protected:
+        void on_start() noexcept { last_yield_ = std::chrono::steady_clock::now(); }
+
+        void on_yield() noexcept {
+            CountingInstrumentation::on_yield();
+            auto now = std::chrono::steady_clock::now();
+            auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_yield_).count();
+            last_yield_ = now;
+
+            std::size_t bucket = 0;
+            while (interval > 1 && bucket + 1 < N_BUCKETS) {
+                interval >>= 1;
+                ++bucket;
+            }
+            buckets_[bucket].store(buckets_[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void on_pause() noexcept { CountingInstrumentation::on_pause(); }
+
+        // paused time isn't a yield interval
+        void on_resume() noexcept { last_yield_ = std::chrono::steady_clock::now(); }
+
+    private:
+        std::chrono::steady_clock::time_point last_yield_; // only accessed by the thread running the worker
+        std::array<std::atomic<std::uint64_t>, N_BUCKETS> buckets_{};
+    };
+}
+
+#endif //WORKERS_MANAGER_COMPACT_POLICIES_HPP
@@ -0,0 +1,276 @@
+/** Tiny-job fusion: many small jobs of the same type run back to back by a single worker. */
+
+#ifndef WORKERS_MANAGER_FUSION_HPP
+#define WORKERS_MANAGER_FUSION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <worker/worker.hpp>
+#include <worker/worker_pool.hpp>
+
+namespace worker {
+    /**
+     * Single job of a fused batch (see JobFuser). Has it's own logical status & result, which are much cheaper
+     * than a worker of it's own. Queued jobs report running status (see PooledWorkerBase).
+     * @tparam Result return type of job's function
+     */
+    template<class Result>
+    class FusedJob {
+    public:
+        FusedJob() = default;
+
+        // non-copyable
+        FusedJob(const FusedJob& other) = delete;
+
+        FusedJob& operator=(const FusedJob& other) = delete;
+
+        /** Returns job status (running, stopped or finished). Thread-safe. */
+        [[nodiscard]] Status status() const noexcept { return status_.load(std::memory_order_acquire); }
+
+        /** Returns job's progress, in the 0-1 range (0%-100%). Thread-safe. */
+        [[nodiscard]] double progress() const noexcept { return progress_; }
+
+        /**
+         * Requests job to stop (non-blocking). Queued job is skipped, running one is stopped on it's next yield.
+         * @return false if job has already finished/stopped
+         */
+        bool request_stop() noexcept {
+            stop_requested_ = true;
+            auto status = this->status();
+            return status != Status::FINISHED && status != Status::STOPPED;
+        }
+
+        /** Waits for job to finish/stop. Thread-safe. */
+        void wait() const { future_.wait(); }
+
+        /**
+         * Returns job's result. Blocks until the result is available (job finished or stopped).
+         * Result can only be obtained once.
+         * @throws std::future_error if future state is invalid (e.g. result already obtained)
+         * @throws any exception thrown by job's function (WorkerStopped if job or it's batch was stopped before it
+         *   started, also if batch worker never ran, e.g. it was rejected or dropped by the pool)
+         */
+        Result result() {
+            if (!future_.valid()) {
+                throw std::future_error(std::future_errc::no_state);
+            }
+            return future_.get();
+        }
+
+    private:
+        template<class Function, class... Args>
+        friend class JobFuser;
+
+        /** Sets final status (after the result is set). */
+        void done(Status status) { status_.store(status, std::memory_order_release); }
+
+        /** Stops job that won't run. */
+        void stop() {
+            promise_.set_exception(std::make_exception_ptr(WorkerStopped()));
+            done(Status::STOPPED);
+        }
+
+        std::atomic<Status> status_ = Status::RUNNING;
+        std::atomic<double> progress_ = 0;
+        std::atomic<bool> stop_requested_ = false;
+        std::promise<Result> promise_;
+        std::future<Result> future_ = promise_.get_future();
+    };
+
+    /**
+     * Fuses small jobs of the same function into batches, each batch is run back to back by a single worker
+     * (AsyncWorker or PooledWorker), which amortizes per-worker overhead (thread creation, scheduling, ...).
+     * Batch is started once it's full or when flushed. Batch worker's progress is the share of it's done jobs.
+     * Pausing/stopping batch worker pauses/stops it's running job (remaining jobs are stopped as well).
+     * Destructor flushes the last batch & waits for all batches to be done. Thread-safe.
+     * @tparam Function job function, accepting yield function as it's first argument (see AsyncWorker)
+     * @tparam Args job function arguments, excluding yield function
+     */
+    template<class Function, class... Args>
+    class JobFuser {
+    public:
+        using result_t = std::invoke_result_t<Function&, yield_function_t, Args...>;
+        using job_t = std::shared_ptr<FusedJob<result_t>>;
+
+        /**
+         * @param f job function
+         * @param batch_size number of jobs run by a single worker (at least 1)
+         * @param options options of batch workers (e.g. job type)
+         * @param pool pool that runs batch workers, each batch runs in it's own thread (AsyncWorker) if nullptr
+         */
+        explicit JobFuser(Function f, std::size_t batch_size, WorkerOptions options = {}, WorkerPool* pool = nullptr)
+                : f_(std::move(f)), batch_size_(std::max<std::size_t>(batch_size, 1)), options_(std::move(options)),
+                  pool_(pool) {}
+
+        ~JobFuser() {
+            flush();
+            for (const auto& worker: workers_) {
+                worker->wait();
+            }
+        }
+
+        // non-copyable
+        JobFuser(const JobFuser& other) = delete;
+
+        JobFuser& operator=(const JobFuser& other) = delete;
+
+        /**
+         * Adds job with passed arguments to the current batch (which is started if full). Returns job's handle.
+         * @throws WorkerRejected if pool doesn't accept the full batch (it's jobs, including this one, are stopped)
+         */
+        template<class... FArgs, class = std::enable_if_t<std::is_constructible_v<std::tuple<Args...>, FArgs&&...>>>
+        job_t submit(FArgs&& ... args) {
+            auto job = std::make_shared<FusedJob<result_t>>();
+
+            std::lock_guard<std::mutex> lock(fuser_m_);
+            batch_.emplace_back(job, std::tuple<Args...>(std::forward<FArgs>(args)...));
+            if (batch_.size() >= batch_size_) {
+                start_batch();
+            }
+            return job;
+        }
+
+        /**
+         * Starts the current (partial) batch. Returns it's worker or nullptr if batch was empty.
+         * @throws WorkerRejected if pool doesn't accept the batch (it's jobs are stopped)
+         */
+        std::shared_ptr<BaseWorker> flush() {
+            std::lock_guard<std::mutex> lock(fuser_m_);
+            return start_batch();
+        }
+
+        /** Returns workers of started batches. */
+        [[nodiscard]] std::vector<std::shared_ptr<BaseWorker>> workers() const {
+            std::lock_guard<std::mutex> lock(fuser_m_);
+            return workers_;
+        }
+
+    private:
+        /**
+         * Jobs with their arguments, owned by the batch function. Jobs that weren't run (batch worker was stopped
+         * while queued, rejected or dropped by the pool, ...) are stopped on destruction, so their results never block.
+         */
+        class Batch : public std::vector<std::pair<job_t, std::tuple<Args...>>> {
+        public:
+            Batch() = default;
+
+            Batch(Batch&& other) noexcept = default;
+
+            Batch& operator=(Batch&& other) noexcept = default;
+
+            ~Batch() {
+                for (auto& [job, args]: *this) {
+                    if (job->status() == Status::RUNNING) {
+                        job->stop();
+                    }
+                }
+            }
+        };
+
+        /** Starts worker that runs the current batch (must be called under fuser_m_). */
+        std::shared_ptr<BaseWorker> start_batch();
+
+        /** Runs batch's jobs back to back (function of batch workers). */
+        static void run_batch(const yield_function_t& yield, Function& f, Batch& batch);
+
+        Function f_;
+        const std::size_t batch_size_;
+        const WorkerOptions options_;
+        WorkerPool* const pool_;
+
+        Batch batch_; // current batch
+        std::vector<std::shared_ptr<BaseWorker>> workers_; // workers of started batches
+        mutable std::mutex fuser_m_; // mutex for accessing current batch & workers
+    };
+
+    /** Constructs JobFuser for passed function & argument types (e.g. make_job_fuser<int>(&fibonacci, 256)). */
+    template<class... Args, class F>
+    std::unique_ptr<JobFuser<std::decay_t<F>, Args...>> make_job_fuser(F&& f, std::size_t batch_size,
+                                                                      WorkerOptions options = {},
+                                                                      WorkerPool* pool = nullptr) {
+        return std::make_unique<JobFuser<std::decay_t<F>, Args...>>(std::forward<F>(f), batch_size,
+                                                                    std::move(options), pool);
+    }
+
+
+    // ******* Implementations ********************************************
+    template<class Function, class... Args>
+    std::shared_ptr<BaseWorker> JobFuser<Function, Args...>::start_batch() {
+        if (batch_.empty()) {
+            return nullptr;
+        }
+
+        // batch & a copy of the function are moved into the worker (batch stops it's jobs if it's never run)
+        auto batch_func = [f = f_, batch = std::move(batch_)](const yield_function_t& yield) mutable {
+            run_batch(yield, f, batch);
+        };
+        batch_ = Batch();
+
+        std::shared_ptr<BaseWorker> worker;
+        if (pool_ != nullptr) {
+            worker = make_pooled_worker(*pool_, options_, std::move(batch_func));
+        }
+        else {
+            worker = make_async_worker(options_, std::move(batch_func));
+        }
+        workers_.push_back(worker);
+        return worker;
+    }
+
+    template<class Function, class... Args>
+    void JobFuser<Function, Args...>::run_batch(const yield_function_t& yield, Function& f, Batch& batch) {
+        auto n_jobs = static_cast<double>(batch.size());
+
+        bool batch_stopped = false;
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            auto& [job, args] = batch[i];
+            batch_stopped = batch_stopped || this_worker::stop_requested();
+            if (batch_stopped || job->stop_requested_) {
+                job->stop();
+                continue;
+            }
+
+            // job's yield also yields the batch worker, with job's progress mapped to batch's progress
+            bool job_stopped = false;
+            yield_function_t job_yield = [&yield, &job = *job, &job_stopped, &batch_stopped, i, n_jobs](double p) {
+                job.progress_ = std::clamp(p, 0., 1.);
+                batch_stopped = batch_stopped || !yield((static_cast<double>(i) + job.progress_) / n_jobs);
+                job_stopped = batch_stopped || job.stop_requested_;
+                return !job_stopped;
+            };
+
+            try {
+                if constexpr(std::is_same_v<result_t, void>) {
+                    std::apply([&f, &job_yield](auto& ... job_args) { f(job_yield, std::move(job_args)...); }, args);
+                    job->promise_.set_value();
+                }
+                else {
+                    job->promise_.set_value(std::apply([&f, &job_yield](auto& ... job_args) {
+                        return f(job_yield, std::move(job_args)...);
+                    }, args));
+                }
+            }
+            catch (...) {
+                // e.g. WorkerStopped thrown by yield-aware utilities
+                job_stopped = job_stopped || job->stop_requested_ || this_worker::stop_requested();
+                job->promise_.set_exception(std::current_exception());
+            }
+
+            if (!job_stopped) {
+                job->progress_ = 1;
+            }
+            job->done(job_stopped ? Status::STOPPED : Status::FINISHED);
+            this_worker::progress((static_cast<double>(i) + 1) / n_jobs);
+        }
+    }
+}
+
+#endif //WORKERS_MANAGER_FUSION_HPP
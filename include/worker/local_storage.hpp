@@ -0,0 +1,131 @@
+/** Worker-local storage: per-worker objects that follow the worker across threads (see WorkerLocal). */
+
+#ifndef WORKERS_MANAGER_LOCAL_STORAGE_HPP
+#define WORKERS_MANAGER_LOCAL_STORAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace worker {
+    namespace detail {
+        /** Lazily initialized, type-erased slots indexed by WorkerLocal keys. Thread-safe. */
+        class LocalStorage {
+        public:
+            LocalStorage() = default;
+
+            ~LocalStorage() { clear(); }
+
+            // non-copyable
+            LocalStorage(const LocalStorage& other) = delete;
+
+            LocalStorage& operator=(const LocalStorage& other) = delete;
+
+            /**
+             * Returns object in passed slot, which is initialized with passed function if it's empty.
+             * Function is called outside of the lock, so it can access other slots. If slot is initialized
+             * concurrently, function is called by each thread, but only the first stored object is kept.
+             */
+            template<class T, class Init>
+            T& get(std::size_t index, const Init& init) {
+                {
+                    std::lock_guard<std::mutex> lock(slots_m_);
+                    if (index < slots_.size() && slots_[index]) {
+                        return *static_cast<T*>(slots_[index].get());
+                    }
+                }
+
+                std::shared_ptr<void> created(new T(init())); // discarded outside of the lock if slot got filled
+                std::lock_guard<std::mutex> lock(slots_m_);
+                if (index >= slots_.size()) {
+                    slots_.resize(index + 1);
+                }
+                auto& slot = slots_[index];
+                if (!slot) {
+                    slot = std::move(created);
+                }
+                return *static_cast<T*>(slot.get());
+            }
+
+            /** Destroys all objects, in reverse order of their keys' creation (outside of the lock). */
+            void clear() {
+                std::vector<std::shared_ptr<void>> slots;
+                {
+                    std::lock_guard<std::mutex> lock(slots_m_);
+                    slots.swap(slots_);
+                }
+                while (!slots.empty()) {
+                    slots.pop_back();
+                }
+            }
+
+            /** Returns next unused slot index (for a new key). */
+            static std::size_t next_index() noexcept {
+                static std::atomic<std::size_t> index_counter = 0;
+                return index_counter++;
+            }
+
+        private:
+            std::vector<std::shared_ptr<void>> slots_;
+            std::mutex slots_m_; // mutex for accessing slots
+        };
+
+        // storage of the worker that's running on the current thread (see CurrentWorkerScope)
+        inline thread_local LocalStorage* current_local_storage = nullptr;
+
+        /** Returns storage of the calling thread, used outside of workers. */
+        inline LocalStorage& thread_local_storage() {
+            static thread_local LocalStorage storage;
+            return storage;
+        }
+    }
+
+    /**
+     * Typed key of a worker-local object. Each worker has it's own object, lazily initialized on first access and
+     * destroyed when the worker is done. Unlike thread_local, objects follow the worker when it's run by pool threads,
+     * nested in another worker's thread or split across helper threads of parallel algorithms (objects are then
+     * shared by those threads). Outside of workers each thread has it's own object.
+     * Initializers can access other worker-local objects (e.g. a cache seeded from a worker-local generator).
+     * Keys are meant to be long-lived (e.g. static), each key permanently takes a slot in every worker's storage.
+     * @tparam T type of the worker-local object
+     */
+    template<class T>
+    class WorkerLocal {
+    public:
+        using init_function_t = std::function<T()>;
+
+        /** Objects are value-initialized. */
+        WorkerLocal() : WorkerLocal([]() { return T(); }) {}
+
+        /** @param init creates object on it's first access by a worker */
+        explicit WorkerLocal(init_function_t init) : init_(std::move(init)) {}
+
+        // non-copyable
+        WorkerLocal(const WorkerLocal& other) = delete;
+
+        WorkerLocal& operator=(const WorkerLocal& other) = delete;
+
+        /** Returns object of the worker running on the calling thread (initializes it on first access). */
+        T& get() const {
+            auto* storage = detail::current_local_storage;
+            if (storage == nullptr) {
+                storage = &detail::thread_local_storage();
+            }
+            return storage->get<T>(index_, init_);
+        }
+
+        T& operator*() const { return get(); }
+
+        T* operator->() const { return &get(); }
+
+    private:
+        const std::size_t index_ = detail::LocalStorage::next_index();
+        const init_function_t init_;
+    };
+}
+
+#endif //WORKERS_MANAGER_LOCAL_STORAGE_HPP
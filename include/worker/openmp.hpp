@@ -0,0 +1,105 @@
+/** Integration of OpenMP parallel regions with worker's pause, stop & progress. Requires OpenMP (e.g. -fopenmp). */
+
+#ifndef WORKERS_MANAGER_OPENMP_HPP
+#define WORKERS_MANAGER_OPENMP_HPP
+
+#ifndef _OPENMP
+#error "worker/openmp.hpp requires OpenMP to be enabled (e.g. -fopenmp)"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+#include <worker/worker.hpp>
+
+namespace worker::omp {
+    /**
+     * Makes the worker that encounters an OpenMP parallel region controllable from all threads of the team.
+     * Must be constructed on the encountering thread (before the region) and shared with the team.
+     * Team threads call checkpoint at chunk boundaries: on pause the whole team parks there and resumes together
+     * on restart, on stop checkpoint returns false and threads should skip their remaining chunks.
+     * Outside of a worker checkpoints are no-ops (always return true).
+     */
+    class Team {
+    public:
+        /** @param total_work total amount of work (e.g. loop iterations) used for progress, 0 for no progress updates */
+        explicit Team(std::size_t total_work = 0) noexcept:
+                owner_(::worker::detail::current_worker), total_work_(total_work) {}
+
+        // non-copyable (shared by reference with the team)
+        Team(const Team& other) = delete;
+
+        Team& operator=(const Team& other) = delete;
+
+        /**
+         * Reports finished work & yields on behalf of the worker. Can be called from any team thread.
+         * @param work_done amount of work done since this thread's last checkpoint
+         * @return boolean indicating whether the team should continue running (true) or cleanly stop (false)
+         */
+        [[nodiscard]] bool checkpoint(std::size_t work_done = 0) {
+            if (stopped()) {
+                return false;
+            }
+            if (owner_ == nullptr) {
+                return true;
+            }
+
+            auto done = work_done_.fetch_add(work_done, std::memory_order_relaxed) + work_done;
+            auto progress = total_work_ > 0 ? static_cast<double>(done) / static_cast<double>(total_work_)
+                                            : owner_->progress();
+
+            ::worker::detail::CurrentWorkerScope worker_scope(owner_);
+            if (!this_worker::yield(progress)) {
+                stopped_.store(true, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        /** Returns true if team has observed a stop request. Lock-free, doesn't yield. */
+        [[nodiscard]] bool stopped() const noexcept { return stopped_.load(std::memory_order_relaxed); }
+
+    private:
+        BaseWorker* owner_;
+        const std::size_t total_work_;
+        std::atomic<std::size_t> work_done_ = 0;
+        std::atomic<bool> stopped_ = false;
+    };
+
+    /**
+     * OpenMP parallel loop over [first, last) with dynamic scheduling of chunk sized blocks.
+     * Calling worker yields on every thread after each chunk (see Team::checkpoint).
+     * Body must not throw (OpenMP regions can't propagate exceptions).
+     * @param body function called with every index in the range
+     * @return true if all iterations were executed, false if worker was stopped (remaining chunks are skipped)
+     */
+    template<class Index, class Body>
+    [[nodiscard]] bool parallel_for(Index first, Index last, Index chunk, Body&& body) {
+        static_assert(std::is_integral_v<Index> && std::is_signed_v<Index>, "OpenMP loops need signed indices");
+        if (last <= first) {
+            return true;
+        }
+
+        chunk = std::max<Index>(chunk, 1);
+        Team team(static_cast<std::size_t>(last - first));
+
+#pragma omp parallel for schedule(dynamic)
+        for (Index chunk_first = first; chunk_first < last; chunk_first += chunk) {
+            if (team.stopped()) {
+                continue; // OpenMP loops can't be exited, skip remaining chunks
+            }
+
+            auto chunk_last = std::min<Index>(last, chunk_first + chunk);
+            for (auto i = chunk_first; i < chunk_last; ++i) {
+                body(i);
+            }
+            (void) team.checkpoint(static_cast<std::size_t>(chunk_last - chunk_first));
+        }
+
+        return !team.stopped();
+    }
+}
+
+#endif //WORKERS_MANAGER_OPENMP_HPP
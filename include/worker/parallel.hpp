@@ -0,0 +1,234 @@
+/**
+ * Parallel algorithms (std::execution::par-style) that run on a ThreadPool and honor the calling worker's
+ * pause, stop & progress on all participating threads.
+ */
+
+#ifndef WORKERS_MANAGER_PARALLEL_HPP
+#define WORKERS_MANAGER_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <worker/worker.hpp>
+#include <worker/thread_pool.hpp>
+
+namespace worker::parallel {
+    // default minimal number of elements processed by a single task between two yields
+    constexpr std::size_t DEFAULT_GRAIN = 4096;
+
+    namespace detail {
+        /**
+         * Shared state of a loop over chunks [0, n_chunks), executed by the calling thread & pool threads.
+         * Pool threads that start after all the chunks were claimed exit without touching the chunk function
+         * or the owner, so the calling thread only needs to wait for claimed chunks.
+         */
+        template<class ChunkFunction>
+        struct ChunkedLoop {
+            BaseWorker* owner; // worker that called the parallel algorithm (can be nullptr)
+            SchedulingClass scheduling; // owner's scheduling class, copied while the owner is alive
+            ChunkFunction* chunk_function;
+            std::size_t n_chunks;
+            double progress_offset, progress_scale; // progress is reported in [offset, offset + scale] range
+
+            std::atomic<std::size_t> next_chunk = 0;
+            std::atomic<std::size_t> finished_chunks = 0; // executed or skipped chunks
+            std::atomic<bool> abort = false; // set on stop or exception, remaining chunks are skipped
+            bool stopped = false; // worker stop was requested (guarded by m)
+            std::exception_ptr error; // first exception thrown by a chunk (guarded by m)
+
+            std::mutex m;
+            std::condition_variable cv;
+
+            /**
+             * Claims & executes chunks until there are none left. Runs on all participating threads.
+             * @param pool_thread whether it runs on a pool thread (which runs with owner's scheduling class)
+             */
+            void participate(bool pool_thread) {
+                // owner waits only for claimed chunks, it might be gone if there are none left
+                auto chunk = next_chunk++;
+                if (chunk >= n_chunks) {
+                    return;
+                }
+
+                // pool threads run with owner's scheduling class until they switch to another task
+                std::optional<ScopedScheduling> scheduling_scope;
+                if (pool_thread) {
+                    scheduling_scope.emplace(scheduling);
+                }
+                // pool threads yield on behalf of the owner, so they pause & stop together with it
+                ::worker::detail::CurrentWorkerScope worker_scope(owner);
+
+                for (; chunk < n_chunks; chunk = next_chunk++) {
+                    if (!abort) {
+                        run_chunk(chunk);
+                    }
+
+                    if (++finished_chunks == n_chunks) {
+                        std::lock_guard<std::mutex> lock(m);
+                        cv.notify_all();
+                    }
+                }
+            }
+
+            /** Executes a single chunk & yields after it. */
+            void run_chunk(std::size_t chunk) {
+                try {
+                    (*chunk_function)(chunk);
+
+                    auto progress = (finished_chunks + 1) / static_cast<double>(n_chunks);
+                    if (!this_worker::yield(progress_offset + progress * progress_scale)) {
+                        std::lock_guard<std::mutex> lock(m);
+                        stopped = true;
+                        abort = true;
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    abort = true;
+                }
+            }
+        };
+
+        /**
+         * Executes chunk_function(chunk) for every chunk in [0, n_chunks) on the calling thread and pool threads.
+         * Blocks until all chunks are executed. Yields (on behalf of the calling worker) after every chunk.
+         * @throws WorkerStopped if calling worker was stopped, exception thrown by chunk_function otherwise
+         */
+        template<class ChunkFunction>
+        void run_chunks(std::size_t n_chunks, ChunkFunction&& chunk_function, ThreadPool& pool,
+                        double progress_offset = 0, double progress_scale = 1) {
+            if (n_chunks == 0) {
+                return;
+            }
+
+            using loop_t = ChunkedLoop<std::remove_reference_t<ChunkFunction>>;
+            auto loop = std::make_shared<loop_t>();
+            loop->owner = ::worker::detail::current_worker;
+            if (loop->owner != nullptr) {
+                loop->scheduling = loop->owner->scheduling();
+            }
+            loop->chunk_function = &chunk_function;
+            loop->n_chunks = n_chunks;
+            loop->progress_offset = progress_offset;
+            loop->progress_scale = progress_scale;
+
+            // calling thread participates as well, so there's no deadlock even if it's a pool thread itself
+            auto n_helpers = std::min(pool.size(), n_chunks - 1);
+            for (std::size_t i = 0; i < n_helpers; ++i) {
+                pool.submit([loop]() { loop->participate(true); });
+            }
+            loop->participate(false);
+
+            std::unique_lock<std::mutex> lock(loop->m);
+            loop->cv.wait(lock, [&loop]() { return loop->finished_chunks == loop->n_chunks; });
+
+            if (loop->error) {
+                std::rethrow_exception(loop->error);
+            }
+            if (loop->stopped) {
+                throw WorkerStopped();
+            }
+        }
+
+        /** Returns number of chunks of (at most) chunk_size elements that cover n elements */
+        inline std::size_t n_chunks(std::size_t n, std::size_t chunk_size) {
+            chunk_size = std::max<std::size_t>(chunk_size, 1);
+            return (n + chunk_size - 1) / chunk_size;
+        }
+    }
+
+    /**
+     * Parallel std::for_each. Calling worker yields (and can be paused/stopped) after every grain elements.
+     * @throws WorkerStopped if calling worker was stopped, exception thrown by f otherwise
+     */
+    template<class RandomIt, class UnaryFunction>
+    void for_each(RandomIt first, RandomIt last, UnaryFunction f, std::size_t grain = DEFAULT_GRAIN,
+                  ThreadPool& pool = ThreadPool::default_pool()) {
+        std::size_t n = std::distance(first, last);
+        grain = std::max<std::size_t>(grain, 1);
+
+        detail::run_chunks(detail::n_chunks(n, grain), [&](std::size_t chunk) {
+            auto chunk_first = first + chunk * grain;
+            auto chunk_last = first + std::min(n, (chunk + 1) * grain);
+            std::for_each(chunk_first, chunk_last, f);
+        }, pool);
+    }
+
+    /**
+     * Parallel std::transform_reduce. Partial results are reduced in range order.
+     * Calling worker yields (and can be paused/stopped) after every grain elements.
+     * @throws WorkerStopped if calling worker was stopped, exception thrown by reduce/transform otherwise
+     */
+    template<class RandomIt, class T, class BinaryReductionOp, class UnaryTransformOp>
+    T transform_reduce(RandomIt first, RandomIt last, T init, BinaryReductionOp reduce, UnaryTransformOp transform,
+                       std::size_t grain = DEFAULT_GRAIN, ThreadPool& pool = ThreadPool::default_pool()) {
+        std::size_t n = std::distance(first, last);
+        grain = std::max<std::size_t>(grain, 1);
+
+        std::vector<std::optional<T>> partial_results(detail::n_chunks(n, grain));
+        detail::run_chunks(partial_results.size(), [&](std::size_t chunk) {
+            auto it = first + chunk * grain;
+            auto chunk_last = first + std::min(n, (chunk + 1) * grain);
+
+            T partial = transform(*it);
+            for (++it; it != chunk_last; ++it) {
+                partial = reduce(std::move(partial), transform(*it));
+            }
+            partial_results[chunk] = std::move(partial);
+        }, pool);
+
+        for (auto& partial: partial_results) {
+            init = reduce(std::move(init), std::move(*partial));
+        }
+        return init;
+    }
+
+    /**
+     * Parallel sort: chunks are sorted in parallel and then merged in parallel rounds of pairwise merges.
+     * Calling worker yields (and can be paused/stopped) after every sorted chunk & merge.
+     * If stopped, range is left in unspecified order.
+     * @throws WorkerStopped if calling worker was stopped, exception thrown by comp otherwise
+     */
+    template<class RandomIt, class Compare = std::less<>>
+    void sort(RandomIt first, RandomIt last, Compare comp = Compare(), std::size_t grain = DEFAULT_GRAIN,
+              ThreadPool& pool = ThreadPool::default_pool()) {
+        std::size_t n = std::distance(first, last);
+        // few chunks per thread, so chunks finish (and yield) in parallel
+        auto chunk_size = std::max(std::max<std::size_t>(grain, 1), n / (4 * (pool.size() + 1)) + 1);
+        auto n_chunks = detail::n_chunks(n, chunk_size);
+
+        // progress is split evenly between the sorting phase & merging rounds
+        std::size_t n_rounds = 0;
+        for (auto width = chunk_size; width < n; width *= 2) {
+            ++n_rounds;
+        }
+        auto phase_scale = 1. / static_cast<double>(n_rounds + 1);
+
+        detail::run_chunks(n_chunks, [&](std::size_t chunk) {
+            std::sort(first + chunk * chunk_size, first + std::min(n, (chunk + 1) * chunk_size), comp);
+        }, pool, 0, phase_scale);
+
+        std::size_t round = 1;
+        for (auto width = chunk_size; width < n; width *= 2, ++round) {
+            detail::run_chunks(detail::n_chunks(n, 2 * width), [&](std::size_t pair) {
+                auto pair_first = pair * 2 * width;
+                auto middle = std::min(n, pair_first + width);
+                auto pair_last = std::min(n, pair_first + 2 * width);
+                std::inplace_merge(first + pair_first, first + middle, first + pair_last, comp);
+            }, pool, round * phase_scale, phase_scale);
+        }
+    }
+}
+
+#endif //WORKERS_MANAGER_PARALLEL_HPP
@@ -0,0 +1,177 @@
+/** Hardware performance counters (instructions, cycles, cache & branch misses) of workers. Linux only. */
+
+#ifndef WORKERS_MANAGER_PERF_COUNTERS_HPP
+#define WORKERS_MANAGER_PERF_COUNTERS_HPP
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace worker {
+    /** Counter values accumulated over worker's execution intervals. */
+    struct PerfSample {
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t llc_misses = 0; // last level cache misses
+        std::uint64_t branch_misses = 0;
+
+        /** Instructions per cycle */
+        [[nodiscard]] double ipc() const noexcept {
+            return cycles > 0 ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0;
+        }
+
+        /** Last level cache misses per 1000 instructions (memory intensity) */
+        [[nodiscard]] double llc_mpki() const noexcept {
+            return instructions > 0 ? 1000. * static_cast<double>(llc_misses) / static_cast<double>(instructions) : 0;
+        }
+
+        PerfSample& operator+=(const PerfSample& other) noexcept {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            llc_misses += other.llc_misses;
+            branch_misses += other.branch_misses;
+            return *this;
+        }
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const PerfSample& sample) {
+        return os << "IPC " << sample.ipc() << ", LLC misses " << sample.llc_misses << " (" << sample.llc_mpki()
+                  << " MPKI), branch misses " << sample.branch_misses;
+    }
+
+    /**
+     * Group of hardware counters measuring the calling thread, from construction until read or destruction
+     * (a single execution interval). Counters are unavailable if perf_event_open isn't supported or
+     * permitted (see /proc/sys/kernel/perf_event_paranoid), in which case reads return zeros.
+     */
+    class PerfCounterGroup {
+    public:
+        PerfCounterGroup() noexcept {
+#ifdef __linux__
+            constexpr std::array<std::uint64_t, N_COUNTERS> configs = {
+                    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                    PERF_COUNT_HW_BRANCH_MISSES};
+
+            for (std::size_t i = 0; i < N_COUNTERS; ++i) {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = i == 0; // whole group is enabled through the leader
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+
+                // calling thread, any CPU
+                fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0));
+                if (fds_[i] < 0) {
+                    close_all();
+                    return;
+                }
+            }
+
+            ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        ~PerfCounterGroup() { close_all(); }
+
+        // non-copyable
+        PerfCounterGroup(const PerfCounterGroup& other) = delete;
+
+        PerfCounterGroup& operator=(const PerfCounterGroup& other) = delete;
+
+        /** Returns true if counters are being measured */
+        [[nodiscard]] bool available() const noexcept { return fds_[0] >= 0; }
+
+        /** Returns counter values since construction */
+        [[nodiscard]] PerfSample read() const noexcept {
+            PerfSample sample;
+#ifdef __linux__
+            if (!available()) {
+                return sample;
+            }
+
+            struct {
+                std::uint64_t nr;
+                std::uint64_t values[N_COUNTERS];
+            } group{};
+            if (::read(fds_[0], &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group))) {
+                return sample;
+            }
+
+            sample.cycles = group.values[0];
+            sample.instructions = group.values[1];
+            sample.llc_misses = group.values[2];
+            sample.branch_misses = group.values[3];
+#endif
+            return sample;
+        }
+
+    private:
+        static constexpr std::size_t N_COUNTERS = 4;
+
+        void close_all() noexcept {
+#ifdef __linux__
+            // members are closed before the leader
+            for (auto i = N_COUNTERS; i-- > 0;) {
+                if (fds_[i] >= 0) {
+                    close(fds_[i]);
+                    fds_[i] = -1;
+                }
+            }
+#endif
+        }
+
+        std::array<int, N_COUNTERS> fds_ = {-1, -1, -1, -1};
+    };
+
+    /** Process-wide counter statistics aggregated per worker type. Thread-safe. */
+    class PerfStats {
+    public:
+        /** Adds sample of a (finished) worker of passed type */
+        void add(const std::string& type, const PerfSample& sample) {
+            std::lock_guard<std::mutex> lock(stats_m_);
+            stats_[type] += sample;
+        }
+
+        /** Returns accumulated sample of passed worker type, if there's any */
+        [[nodiscard]] std::optional<PerfSample> find(const std::string& type) const {
+            std::lock_guard<std::mutex> lock(stats_m_);
+            auto it = stats_.find(type);
+            return it != stats_.end() ? std::optional<PerfSample>(it->second) : std::nullopt;
+        }
+
+        /** Returns accumulated samples, keyed by worker type */
+        [[nodiscard]] std::map<std::string, PerfSample> per_type() const {
+            std::lock_guard<std::mutex> lock(stats_m_);
+            return stats_;
+        }
+
+        /** Returns process-wide statistics that workers report to */
+        static PerfStats& global() {
+            static PerfStats stats;
+            return stats;
+        }
+
+    private:
+        std::map<std::string, PerfSample> stats_;
+        mutable std::mutex stats_m_;
+    };
+}
+
+#endif //WORKERS_MANAGER_PERF_COUNTERS_HPP
@@ -0,0 +1,343 @@
+/** Scheduling policies for WorkerPool (see PoolScheduler). */
+
+#ifndef WORKERS_MANAGER_POOL_SCHEDULERS_HPP
+#define WORKERS_MANAGER_POOL_SCHEDULERS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <worker/perf_counters.hpp>
+#include <worker/runtime_model.hpp>
+#include <worker/worker_pool.hpp>
+
+namespace worker {
+    namespace detail {
+        /** Removes & returns the earliest submitted worker from queue keyed by (priority, submission number). */
+        template<class Priority>
+        std::shared_ptr<PooledWorkerBase> drop_oldest(
+                std::map<std::pair<Priority, std::uint64_t>, std::shared_ptr<PooledWorkerBase>>& queue) {
+            auto oldest = std::min_element(queue.begin(), queue.end(), [](const auto& a, const auto& b) {
+                return a.first.second < b.first.second;
+            });
+            if (oldest == queue.end()) {
+                return nullptr;
+            }
+            auto worker = std::move(oldest->second);
+            queue.erase(oldest);
+            return worker;
+        }
+    }
+
+    /**
+     * Cache-aware co-scheduling: limits the number of memory intensive (LLC/memory-bandwidth heavy) workers
+     * that run on the same socket at once and interleaves them with compute-bound ones.
+     * Worker types are classified by their LLC misses per 1000 instructions, measured by performance counters
+     * (see WorkerOptions::perf_counters & PerfStats). Explicit hints take precedence over measurements,
+     * which makes the policy usable where counters are unavailable. Types without profile are compute-bound.
+     * Otherwise queued workers run in submission order.
+     */
+    class CacheAwareScheduler : public PoolScheduler {
+    public:
+        /**
+         * @param max_memory_intensive_per_socket maximum number of memory intensive workers running on a socket
+         * @param mpki_threshold LLC misses per 1000 instructions from which worker type is memory intensive
+         * @param stats per-type profiles
+         */
+        explicit CacheAwareScheduler(std::size_t max_memory_intensive_per_socket = 1, double mpki_threshold = 5,
+                                     const PerfStats& stats = PerfStats::global()) :
+                max_memory_intensive_(std::max<std::size_t>(max_memory_intensive_per_socket, 1)),
+                mpki_threshold_(mpki_threshold), stats_(stats) {}
+
+        /**
+         * Explicitly classifies worker type as memory intensive (or compute-bound), regardless of measurements.
+         * Must be called before the scheduler is passed to the pool.
+         */
+        void set_memory_intensive(const std::string& type, bool memory_intensive) {
+            hints_[type] = memory_intensive;
+        }
+
+        void push(std::shared_ptr<PooledWorkerBase> worker) override { queue_.push_back(std::move(worker)); }
+
+        std::shared_ptr<PooledWorkerBase> pop(const PoolSlot& slot) override {
+            auto& n_memory_intensive = running_memory_intensive_[slot.socket];
+
+            // first queued worker that doesn't exceed the socket's limit
+            for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+                bool is_memory_intensive = memory_intensive((*it)->type());
+                if (is_memory_intensive && n_memory_intensive >= max_memory_intensive_) {
+                    continue;
+                }
+
+                auto worker = std::move(*it);
+                queue_.erase(it);
+                if (is_memory_intensive) {
+                    ++n_memory_intensive;
+                    memory_intensive_workers_.insert(worker.get());
+                }
+                return worker;
+            }
+            return nullptr;
+        }
+
+        void done(const PooledWorkerBase& worker, const PoolSlot& slot) override {
+            if (memory_intensive_workers_.erase(&worker) > 0) {
+                --running_memory_intensive_[slot.socket];
+            }
+        }
+
+        std::shared_ptr<PooledWorkerBase> drop_oldest() override {
+            if (queue_.empty()) {
+                return nullptr;
+            }
+            auto worker = std::move(queue_.front());
+            queue_.pop_front();
+            return worker;
+        }
+
+        [[nodiscard]] bool empty() const override { return queue_.empty(); }
+
+        /** Returns true if workers of passed type are memory intensive. */
+        [[nodiscard]] bool memory_intensive(const std::string& type) const {
+            if (auto hint = hints_.find(type); hint != hints_.end()) {
+                return hint->second;
+            }
+            auto profile = stats_.find(type);
+            return profile && profile->llc_mpki() >= mpki_threshold_;
+        }
+
+    private:
+        const std::size_t max_memory_intensive_;
+        const double mpki_threshold_;
+        const PerfStats& stats_;
+        std::map<std::string, bool> hints_;
+
+        std::deque<std::shared_ptr<PooledWorkerBase>> queue_;
+        std::map<int, std::size_t> running_memory_intensive_; // per socket
+        std::set<const PooledWorkerBase*> memory_intensive_workers_; // running memory intensive workers
+    };
+
+    /**
+     * Shortest (remaining) job first: runs the queued worker with the shortest predicted remaining runtime,
+     * which is predicted runtime × (1 - progress) (see RuntimeModel & WorkerOptions::size).
+     * When preemptive (SRPT), running workers are preempted at their yields by submitted workers with shorter
+     * remaining runtime. Workers of types without finished runs are predicted with the default runtime.
+     * Workers with the same prediction run in submission order.
+     */
+    class ShortestJobScheduler : public PoolScheduler {
+    public:
+        using duration_t = RuntimeModel::duration_t;
+
+        /**
+         * @param default_runtime predicted runtime of workers of unknown types
+         * @param preemptive preempts running workers by shorter ones (SRPT), otherwise workers run to completion (SJF)
+         * @param model runtime predictor
+         */
+        explicit ShortestJobScheduler(duration_t default_runtime = std::chrono::seconds(1), bool preemptive = true,
+                                      const RuntimeModel& model = RuntimeModel::global()) :
+                default_runtime_(default_runtime), preemptive_(preemptive), model_(model) {}
+
+        void push(std::shared_ptr<PooledWorkerBase> worker) override {
+            // queued workers don't progress, so their remaining runtime is predicted once
+            auto remaining = remaining_runtime(*worker);
+            queue_.emplace(std::make_pair(remaining, n_pushed_++), std::move(worker));
+        }
+
+        std::shared_ptr<PooledWorkerBase> pop(const PoolSlot&) override {
+            if (queue_.empty()) {
+                return nullptr;
+            }
+            auto worker = std::move(queue_.begin()->second);
+            queue_.erase(queue_.begin());
+            return worker;
+        }
+
+        bool preempt(const PooledWorkerBase& running, const PoolSlot&) override {
+            return preemptive_ && !queue_.empty() && queue_.begin()->first.first < remaining_runtime(running);
+        }
+
+        std::shared_ptr<PooledWorkerBase> drop_oldest() override { return detail::drop_oldest(queue_); }
+
+        [[nodiscard]] bool empty() const override { return queue_.empty(); }
+
+        /** Returns predicted remaining runtime of passed worker */
+        [[nodiscard]] duration_t remaining_runtime(const BaseWorker& worker) const {
+            auto runtime = model_.predict(worker.type(), worker.size()).value_or(default_runtime_);
+            return runtime * (1 - worker.progress());
+        }
+
+    private:
+        const duration_t default_runtime_;
+        const bool preemptive_;
+        const RuntimeModel& model_;
+
+        // queued workers ordered by predicted remaining runtime & submission
+        std::map<std::pair<duration_t, std::uint64_t>, std::shared_ptr<PooledWorkerBase>> queue_;
+        std::uint64_t n_pushed_ = 0;
+    };
+
+    /**
+     * Earliest deadline first: runs queued workers in the order of their deadlines (see WorkerOptions::deadline),
+     * workers without deadlines run after them in submission order. Running workers are preempted at their yields
+     * by submitted workers with earlier deadlines.
+     * Workers with deadlines are admission tested: worker is rejected if it would increase the number of predicted
+     * deadline misses. Misses are predicted by simulating EDF over running & queued workers, using their predicted
+     * runtimes (see RuntimeModel). Deadline misses of finished workers are counted.
+     */
+    class DeadlineScheduler : public PoolScheduler {
+    public:
+        using clock_t = std::chrono::steady_clock;
+        using duration_t = RuntimeModel::duration_t;
+
+        /**
+         * @param admission_test rejects workers that would cause deadline misses (otherwise all workers are admitted)
+         * @param default_runtime predicted runtime of workers of unknown types (optimistic by default)
+         * @param model runtime predictor
+         */
+        explicit DeadlineScheduler(bool admission_test = true, duration_t default_runtime = duration_t::zero(),
+                                   const RuntimeModel& model = RuntimeModel::global()) :
+                admission_test_(admission_test), default_runtime_(default_runtime), model_(model) {}
+
+        void init(const std::vector<PoolSlot>& slots) override {
+            for (const auto& slot: slots) {
+                running_[slot.thread];
+            }
+        }
+
+        bool admit(const PooledWorkerBase& worker) override {
+            if (!admission_test_ || !worker.deadline()) {
+                return true;
+            }
+            if (predicted_misses(&worker) > predicted_misses(nullptr)) {
+                ++n_rejected_;
+                return false;
+            }
+            return true;
+        }
+
+        void push(std::shared_ptr<PooledWorkerBase> worker) override {
+            auto deadline = deadline_of(*worker);
+            queue_.emplace(std::make_pair(deadline, n_pushed_++), std::move(worker));
+        }
+
+        std::shared_ptr<PooledWorkerBase> pop(const PoolSlot& slot) override {
+            if (queue_.empty()) {
+                return nullptr;
+            }
+            auto worker = std::move(queue_.begin()->second);
+            queue_.erase(queue_.begin());
+            running_[slot.thread].push_back(worker.get());
+            return worker;
+        }
+
+        bool preempt(const PooledWorkerBase& running, const PoolSlot&) override {
+            return !queue_.empty() && queue_.begin()->first.first < deadline_of(running);
+        }
+
+        std::shared_ptr<PooledWorkerBase> drop_oldest() override { return detail::drop_oldest(queue_); }
+
+        void done(const PooledWorkerBase& worker, const PoolSlot& slot) override {
+            auto& running = running_[slot.thread];
+            running.erase(std::find(running.begin(), running.end(), &worker));
+
+            if (worker.deadline_missed()) {
+                ++n_missed_;
+            }
+            else if (worker.deadline() && worker.status() == Status::FINISHED) {
+                ++n_met_;
+            }
+        }
+
+        [[nodiscard]] bool empty() const override { return queue_.empty(); }
+
+        /** Returns number of workers that finished after their deadline. Thread-safe. */
+        [[nodiscard]] std::uint64_t deadline_misses() const noexcept { return n_missed_; }
+
+        /** Returns number of workers that finished before their deadline. Thread-safe. */
+        [[nodiscard]] std::uint64_t deadlines_met() const noexcept { return n_met_; }
+
+        /** Returns number of workers rejected by the admission test. Thread-safe. */
+        [[nodiscard]] std::uint64_t n_rejected() const noexcept { return n_rejected_; }
+
+    private:
+        /** Returns worker's deadline, workers without deadline have the latest one. */
+        static clock_t::time_point deadline_of(const BaseWorker& worker) {
+            return worker.deadline().value_or(clock_t::time_point::max());
+        }
+
+        /** Returns predicted remaining runtime of passed worker */
+        [[nodiscard]] clock_t::duration remaining_runtime(const BaseWorker& worker) const {
+            auto runtime = model_.predict(worker.type(), worker.size()).value_or(default_runtime_);
+            return std::chrono::duration_cast<clock_t::duration>(runtime * (1 - worker.progress()));
+        }
+
+        /** Predicts number of queued workers (& optional candidate) that would miss their deadlines. */
+        [[nodiscard]] std::size_t predicted_misses(const PooledWorkerBase* candidate) const {
+            auto now = clock_t::now();
+
+            // slots are free once running workers with deadlines are done (others are preempted by queued ones)
+            std::vector<clock_t::time_point> free_at;
+            for (const auto& [thread, running]: running_) {
+                auto slot_free_at = now;
+                for (const auto* worker: running) {
+                    if (worker->deadline()) {
+                        slot_free_at += remaining_runtime(*worker);
+                    }
+                }
+                free_at.push_back(slot_free_at);
+            }
+            if (free_at.empty()) {
+                free_at.push_back(now);
+            }
+
+            // workers with deadlines in EDF order (queue is already ordered)
+            std::vector<const PooledWorkerBase*> workers;
+            for (const auto& [key, worker]: queue_) {
+                if (!worker->deadline()) {
+                    break;
+                }
+                if (candidate != nullptr && key.first > *candidate->deadline()) {
+                    workers.push_back(std::exchange(candidate, nullptr));
+                }
+                workers.push_back(worker.get());
+            }
+            if (candidate != nullptr) {
+                workers.push_back(candidate);
+            }
+
+            // each worker runs on the slot that's free first
+            std::size_t n_misses = 0;
+            for (const auto* worker: workers) {
+                auto slot_free_at = std::min_element(free_at.begin(), free_at.end());
+                *slot_free_at += remaining_runtime(*worker);
+                if (*slot_free_at > *worker->deadline()) {
+                    ++n_misses;
+                }
+            }
+            return n_misses;
+        }
+
+        const bool admission_test_;
+        const duration_t default_runtime_;
+        const RuntimeModel& model_;
+
+        // queued workers ordered by deadline & submission
+        std::map<std::pair<clock_t::time_point, std::uint64_t>, std::shared_ptr<PooledWorkerBase>> queue_;
+        std::uint64_t n_pushed_ = 0;
+        std::map<std::size_t, std::vector<const PooledWorkerBase*>> running_; // per pool thread (including suspended)
+
+        std::atomic<std::uint64_t> n_missed_ = 0;
+        std::atomic<std::uint64_t> n_met_ = 0;
+        std::atomic<std::uint64_t> n_rejected_ = 0;
+    };
+}
+
+#endif //WORKERS_MANAGER_POOL_SCHEDULERS_HPP
@@ -0,0 +1,434 @@
+/** Registry of workers with a label index for fleet queries (see WorkerRegistry). */
+
+#ifndef WORKERS_MANAGER_REGISTRY_HPP
+#define WORKERS_MANAGER_REGISTRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <worker/worker.hpp>
+
+namespace worker {
+    namespace detail {
+        /**
+         * Compressed bitmap (roaring-style): bits are grouped into chunks of 2^16 & only non-empty chunks are stored
+         * (sorted by their key). Sparse chunks store sorted low 16 bits of their set bits (2 bytes per bit), chunks
+         * with more than MAX_ARRAY_SIZE bits are converted to plain 8KiB bitmaps. Memory therefore stays proportional
+         * to the number of set bits, however they're spread, and bitmaps are intersected chunk by chunk.
+         */
+        class Bitmap {
+        public:
+            void set(std::size_t bit) {
+                auto it = find_chunk(bit >> 16);
+                if (it == chunks_.end() || it->key != bit >> 16) {
+                    it = chunks_.insert(it, Chunk{bit >> 16});
+                }
+                if (it->set(static_cast<std::uint16_t>(bit))) {
+                    ++cardinality_;
+                }
+            }
+
+            void reset(std::size_t bit) {
+                auto it = find_chunk(bit >> 16);
+                if (it == chunks_.end() || it->key != bit >> 16 || !it->reset(static_cast<std::uint16_t>(bit))) {
+                    return;
+                }
+                --cardinality_;
+                if (it->cardinality == 0) {
+                    chunks_.erase(it);
+                }
+            }
+
+            [[nodiscard]] bool empty() const noexcept { return cardinality_ == 0; }
+
+            /** Returns number of set bits. */
+            [[nodiscard]] std::size_t size() const noexcept { return cardinality_; }
+
+            /** Returns bits set in both bitmaps. */
+            [[nodiscard]] Bitmap operator&(const Bitmap& other) const {
+                Bitmap result;
+                auto it = chunks_.begin(), other_it = other.chunks_.begin();
+                while (it != chunks_.end() && other_it != other.chunks_.end()) {
+                    if (it->key < other_it->key) {
+                        ++it;
+                    }
+                    else if (other_it->key < it->key) {
+                        ++other_it;
+                    }
+                    else {
+                        auto chunk = *it & *other_it;
+                        if (chunk.cardinality > 0) {
+                            result.cardinality_ += chunk.cardinality;
+                            result.chunks_.push_back(std::move(chunk));
+                        }
+                        ++it;
+                        ++other_it;
+                    }
+                }
+                return result;
+            }
+
+            /** Calls passed function with every set bit, in increasing order. */
+            template<class F>
+            void for_each(F f) const {
+                for (const auto& chunk: chunks_) {
+                    auto high = chunk.key << 16;
+                    if (!chunk.bits) {
+                        for (auto low: chunk.array) {
+                            f(high | low);
+                        }
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < BITMAP_WORDS; ++i) {
+                        for (auto word = (*chunk.bits)[i]; word != 0; word &= word - 1) {
+                            f(high | (i * 64 + lowest_bit(word)));
+                        }
+                    }
+                }
+            }
+
+        private:
+            // array chunks that grow beyond this are converted to bitmaps (both take 8KiB at this size)
+            static constexpr std::size_t MAX_ARRAY_SIZE = 4096;
+            static constexpr std::size_t BITMAP_WORDS = (std::size_t(1) << 16) / 64;
+
+            using bitmap_t = std::array<std::uint64_t, BITMAP_WORDS>;
+
+            /** Set bits with the same high bits (key), as a sorted array of low bits or as a bitmap. */
+            struct Chunk {
+                explicit Chunk(std::size_t chunk_key) : key(chunk_key) {}
+
+                std::size_t key = 0;
+                std::size_t cardinality = 0;
+                std::vector<std::uint16_t> array; // sorted low bits, used while chunk is sparse
+                std::unique_ptr<bitmap_t> bits; // used once chunk is dense (array is empty then)
+
+                /** Returns true if bit wasn't set yet. */
+                bool set(std::uint16_t low) {
+                    if (bits) {
+                        auto& word = (*bits)[low / 64];
+                        auto mask = std::uint64_t(1) << (low % 64);
+                        if ((word & mask) != 0) {
+                            return false;
+                        }
+                        word |= mask;
+                        ++cardinality;
+                        return true;
+                    }
+
+                    auto it = std::lower_bound(array.begin(), array.end(), low);
+                    if (it != array.end() && *it == low) {
+                        return false;
+                    }
+                    array.insert(it, low);
+                    ++cardinality;
+                    if (array.size() > MAX_ARRAY_SIZE) {
+                        to_bitmap();
+                    }
+                    return true;
+                }
+
+                /** Returns true if bit was set. */
+                bool reset(std::uint16_t low) {
+                    if (bits) {
+                        auto& word = (*bits)[low / 64];
+                        auto mask = std::uint64_t(1) << (low % 64);
+                        if ((word & mask) == 0) {
+                            return false;
+                        }
+                        word &= ~mask;
+                        // converted back with hysteresis, so chunks around the limit aren't converted back & forth
+                        if (--cardinality <= MAX_ARRAY_SIZE / 2) {
+                            to_array();
+                        }
+                        return true;
+                    }
+
+                    auto it = std::lower_bound(array.begin(), array.end(), low);
+                    if (it == array.end() || *it != low) {
+                        return false;
+                    }
+                    array.erase(it);
+                    --cardinality;
+                    return true;
+                }
+
+                /** Returns bits set in both chunks (of the same key). */
+                Chunk operator&(const Chunk& other) const {
+                    Chunk result{key};
+                    if (!bits && !other.bits) {
+                        std::set_intersection(array.begin(), array.end(), other.array.begin(), other.array.end(),
+                                              std::back_inserter(result.array));
+                    }
+                    else if (!bits || !other.bits) {
+                        const auto& sparse = bits ? other : *this;
+                        const auto& dense = bits ? *this : other;
+                        std::copy_if(sparse.array.begin(), sparse.array.end(), std::back_inserter(result.array),
+                                     [&dense](std::uint16_t low) {
+                                         return ((*dense.bits)[low / 64] >> (low % 64) & 1) != 0;
+                                     });
+                    }
+                    else {
+                        result.bits = std::make_unique<bitmap_t>();
+                        for (std::size_t i = 0; i < BITMAP_WORDS; ++i) {
+                            (*result.bits)[i] = (*bits)[i] & (*other.bits)[i];
+                            result.cardinality += std::bitset<64>((*result.bits)[i]).count();
+                        }
+                        if (result.cardinality <= MAX_ARRAY_SIZE) {
+                            result.to_array();
+                        }
+                        return result;
+                    }
+                    result.cardinality = result.array.size();
+                    return result;
+                }
+
+                void to_bitmap() {
+                    bits = std::make_unique<bitmap_t>();
+                    for (auto low: array) {
+                        (*bits)[low / 64] |= std::uint64_t(1) << (low % 64);
+                    }
+                    array = std::vector<std::uint16_t>();
+                }
+
+                void to_array() {
+                    array.reserve(cardinality);
+                    for (std::size_t i = 0; i < BITMAP_WORDS; ++i) {
+                        for (auto word = (*bits)[i]; word != 0; word &= word - 1) {
+                            array.push_back(static_cast<std::uint16_t>(i * 64 + lowest_bit(word)));
+                        }
+                    }
+                    bits.reset();
+                }
+            };
+
+            /** Returns index of the lowest set bit of a non-zero word (De Bruijn multiplication, portable). */
+            static std::size_t lowest_bit(std::uint64_t word) noexcept {
+                static constexpr std::uint8_t DE_BRUIJN_BITS[64] = {
+                        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4, 62, 55, 59, 36, 53, 51, 43, 22, 45,
+                        39, 33, 30, 24, 18, 12, 5, 63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46,
+                        26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6};
+                return DE_BRUIJN_BITS[((word & (~word + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+            }
+
+            /** Returns first chunk with key that's not less than passed one. */
+            std::vector<Chunk>::iterator find_chunk(std::size_t key) {
+                return std::lower_bound(chunks_.begin(), chunks_.end(), key,
+                                        [](const Chunk& chunk, std::size_t chunk_key) { return chunk.key < chunk_key; });
+            }
+
+            std::vector<Chunk> chunks_; // non-empty chunks, sorted by their keys
+            std::size_t cardinality_ = 0; // number of set bits
+        };
+    }
+
+    /** Snapshots of registered workers that changed since an epoch (see WorkerRegistry::snapshot). */
+    struct RegistrySnapshot {
+        std::uint64_t epoch = 0; // pass to the next snapshot call to only get workers changed after this one
+        std::vector<WorkerSnapshot> workers;
+    };
+
+    /**
+     * Set of workers indexed by their labels (see WorkerOptions::labels), for queries & bulk control of large fleets
+     * (e.g. all paused workers of a tenant with a given type). Each worker takes a dense slot & every label value
+     * has a compressed bitmap of slots, so queries intersect bitmaps instead of scanning all workers.
+     * Status isn't indexed (it changes without the registry), it's checked only for workers with matching labels.
+     * Registry also keeps a change epoch of every worker, so monitoring clients can fetch only changed workers.
+     * Registry shares ownership of registered workers. Thread-safe.
+     */
+    class WorkerRegistry {
+    public:
+        using worker_ptr_t = std::shared_ptr<BaseWorker>;
+
+        WorkerRegistry() = default;
+
+        // non-copyable
+        WorkerRegistry(const WorkerRegistry& other) = delete;
+
+        WorkerRegistry& operator=(const WorkerRegistry& other) = delete;
+
+        /** Registers worker & indexes it's labels. No-op if worker is already registered. */
+        void add(worker_ptr_t worker);
+
+        /**
+         * Unregisters worker.
+         * @return false if worker wasn't registered
+         */
+        bool remove(const BaseWorker& worker);
+
+        /**
+         * Returns registered workers that have all passed labels (all workers if there are none) and passed status.
+         * Workers are returned in the order of their slots.
+         */
+        [[nodiscard]] std::vector<worker_ptr_t> find(const labels_t& labels,
+                                                     std::optional<Status> status = std::nullopt) const;
+
+        /**
+         * Returns snapshots of registered workers whose status, progress (by at least 0.1%) or phase changed (or that
+         * were registered) since passed epoch - all workers for epoch 0. Workers are returned in the order of their
+         * slots.
+         * Every call starts a new epoch: workers are compared to the previous call (lock-free change counters, see
+         * BaseWorker::change_count) & changed ones are assigned the new epoch, which is returned with snapshots.
+         * Removed workers aren't reported.
+         */
+        [[nodiscard]] RegistrySnapshot snapshot(std::uint64_t since = 0);
+
+        /** Returns number of registered workers. */
+        [[nodiscard]] std::size_t size() const {
+            std::lock_guard<std::mutex> lock(registry_m_);
+            return slot_of_.size();
+        }
+
+    private:
+        struct Slot {
+            worker_ptr_t worker; // nullptr for free slots
+            std::uint64_t change_count = 0; // worker's change count seen by the last snapshot
+            std::uint64_t changed_epoch = 0; // epoch in which worker's change was seen
+        };
+
+        std::vector<Slot> slots_; // registered workers
+        std::vector<std::size_t> free_slots_; // reused before slots_ grows
+        std::unordered_map<worker_id_t, std::size_t> slot_of_; // slots of registered workers
+        std::map<std::pair<std::string, std::string>, detail::Bitmap> index_; // slots per label key & value
+        detail::Bitmap occupied_; // slots of all registered workers
+        std::uint64_t epoch_ = 0; // epoch of the last snapshot
+        mutable std::mutex registry_m_; // mutex for accessing slots & index
+    };
+
+
+    // ******* Implementations ********************************************
+    inline void WorkerRegistry::add(worker_ptr_t worker) {
+        std::lock_guard<std::mutex> lock(registry_m_);
+        if (slot_of_.count(worker->id()) > 0) {
+            return;
+        }
+
+        std::size_t slot;
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        else {
+            slot = slots_.size();
+            slots_.emplace_back();
+        }
+
+        for (const auto& label: worker->labels()) {
+            index_[label].set(slot);
+        }
+        occupied_.set(slot);
+        slot_of_[worker->id()] = slot;
+        auto change_count = worker->change_count();
+        // registration is a change seen by the next snapshot
+        slots_[slot] = {std::move(worker), change_count, epoch_ + 1};
+    }
+
+    inline bool WorkerRegistry::remove(const BaseWorker& worker) {
+        worker_ptr_t released; // released outside of the lock (registry might be worker's last owner)
+        std::lock_guard<std::mutex> lock(registry_m_);
+        auto it = slot_of_.find(worker.id());
+        if (it == slot_of_.end()) {
+            return false;
+        }
+
+        auto slot = it->second;
+        for (const auto& label: worker.labels()) {
+            auto index_it = index_.find(label);
+            index_it->second.reset(slot);
+            if (index_it->second.empty()) {
+                index_.erase(index_it);
+            }
+        }
+        occupied_.reset(slot);
+        slot_of_.erase(it);
+        free_slots_.push_back(slot);
+        released = std::move(slots_[slot].worker);
+        return true;
+    }
+
+    inline std::vector<WorkerRegistry::worker_ptr_t> WorkerRegistry::find(const labels_t& labels,
+                                                                          std::optional<Status> status) const {
+        std::vector<worker_ptr_t> matching;
+        std::unique_lock<std::mutex> lock(registry_m_);
+
+        // bitmaps are intersected from the sparsest one, which keeps intermediate results small
+        std::vector<const detail::Bitmap*> bitmaps;
+        for (const auto& label: labels) {
+            auto it = index_.find(label);
+            if (it == index_.end()) {
+                return matching;
+            }
+            bitmaps.push_back(&it->second);
+        }
+        std::sort(bitmaps.begin(), bitmaps.end(), [](const detail::Bitmap* a, const detail::Bitmap* b) {
+            return a->size() < b->size();
+        });
+
+        auto collect = [this, &matching](const detail::Bitmap& slots) {
+            slots.for_each([this, &matching](std::size_t slot) { matching.push_back(slots_[slot].worker); });
+        };
+        if (bitmaps.empty()) {
+            collect(occupied_);
+        }
+        else if (bitmaps.size() == 1) {
+            collect(*bitmaps.front());
+        }
+        else {
+            auto slots = *bitmaps[0] & *bitmaps[1];
+            for (std::size_t i = 2; i < bitmaps.size() && !slots.empty(); ++i) {
+                slots = slots & *bitmaps[i];
+            }
+            collect(slots);
+        }
+        lock.unlock();
+
+        // status is only checked for workers with matching labels
+        if (status) {
+            matching.erase(std::remove_if(matching.begin(), matching.end(), [&status](const worker_ptr_t& worker) {
+                return worker->status() != *status;
+            }), matching.end());
+        }
+        return matching;
+    }
+
+    inline RegistrySnapshot WorkerRegistry::snapshot(std::uint64_t since) {
+        RegistrySnapshot snapshot;
+        std::vector<worker_ptr_t> changed;
+        {
+            std::lock_guard<std::mutex> lock(registry_m_);
+            snapshot.epoch = ++epoch_;
+            occupied_.for_each([this, since, &snapshot, &changed](std::size_t index) {
+                auto& slot = slots_[index];
+                auto change_count = slot.worker->change_count();
+                if (change_count != slot.change_count) {
+                    slot.change_count = change_count;
+                    slot.changed_epoch = snapshot.epoch;
+                }
+                if (slot.changed_epoch > since) {
+                    changed.push_back(slot.worker);
+                }
+            });
+        }
+
+        // workers are snapshotted outside of the lock (changes made meanwhile are also reported by the next call)
+        snapshot.workers.reserve(changed.size());
+        for (const auto& worker: changed) {
+            snapshot.workers.push_back(worker->snapshot());
+        }
+        return snapshot;
+    }
+}
+
+#endif //WORKERS_MANAGER_REGISTRY_HPP
@@ -0,0 +1,83 @@
+/** Runtime statistics of finished workers, used to predict runtimes of new ones (see ShortestJobScheduler). */
+
+#ifndef WORKERS_MANAGER_RUNTIME_MODEL_HPP
+#define WORKERS_MANAGER_RUNTIME_MODEL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace worker {
+    /**
+     * Lightweight runtime predictor. Runtimes of finished workers are tracked per worker type and size bucket
+     * (see WorkerOptions::size), where buckets grow exponentially (0, 1, 2-3, 4-7, ...).
+     * Prediction is an exponentially weighted average of the bucket's runtimes (recent runs weigh more),
+     * nearest bucket of the same type is used for sizes that weren't seen yet. Thread-safe.
+     */
+    class RuntimeModel {
+    public:
+        using duration_t = std::chrono::duration<double>; // seconds
+
+        /** @param smoothing weight of the newest runtime in the bucket's average, in the (0, 1] range */
+        explicit RuntimeModel(double smoothing = 0.2) : smoothing_(smoothing) {}
+
+        // non-copyable
+        RuntimeModel(const RuntimeModel& other) = delete;
+
+        RuntimeModel& operator=(const RuntimeModel& other) = delete;
+
+        /** Adds runtime of a finished worker of passed type & size */
+        void add(const std::string& type, std::uint64_t size, duration_t runtime) {
+            std::lock_guard<std::mutex> lock(buckets_m_);
+            auto [it, inserted] = buckets_.try_emplace({type, bucket(size)}, runtime);
+            if (!inserted) {
+                it->second += smoothing_ * (runtime - it->second);
+            }
+        }
+
+        /** Returns predicted runtime of a worker of passed type & size, if there are any runtimes of it's type */
+        [[nodiscard]] std::optional<duration_t> predict(const std::string& type, std::uint64_t size) const {
+            std::lock_guard<std::mutex> lock(buckets_m_);
+            auto size_bucket = bucket(size);
+
+            // nearest bucket of the type (buckets of the type are adjacent in the map)
+            std::optional<duration_t> prediction;
+            int distance = 0;
+            for (auto it = buckets_.lower_bound({type, 0}); it != buckets_.end() && it->first.first == type; ++it) {
+                int bucket_distance = std::abs(it->first.second - size_bucket);
+                if (!prediction || bucket_distance < distance) {
+                    prediction = it->second;
+                    distance = bucket_distance;
+                }
+            }
+            return prediction;
+        }
+
+        /** Returns size bucket of passed size (number of significant bits) */
+        static int bucket(std::uint64_t size) noexcept {
+            int bucket = 0;
+            for (; size > 0; size >>= 1) {
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        /** Returns process-wide model that workers report to */
+        static RuntimeModel& global() {
+            static RuntimeModel model;
+            return model;
+        }
+
+    private:
+        const double smoothing_;
+        std::map<std::pair<std::string, int>, duration_t> buckets_; // average runtime per type & size bucket
+        mutable std::mutex buckets_m_; // mutex for accessing buckets
+    };
+}
+
+#endif //WORKERS_MANAGER_RUNTIME_MODEL_HPP
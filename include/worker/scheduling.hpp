@@ -0,0 +1,195 @@
+/** OS scheduling classes (policy, nice value, real-time priority) that workers can run with. */
+
+#ifndef WORKERS_MANAGER_SCHEDULING_HPP
+#define WORKERS_MANAGER_SCHEDULING_HPP
+
+#ifdef __linux__
+
+#include <linux/capability.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+#include <cerrno>
+
+namespace worker {
+    enum class SchedulingPolicy {
+        INHERIT, // keep scheduling of the thread that runs the worker
+        NORMAL, // SCHED_OTHER with nice value
+        BATCH, // SCHED_BATCH with nice value (CPU-bound, non-interactive)
+        IDLE, // SCHED_IDLE (runs only when CPU would be idle otherwise)
+        FIFO, // SCHED_FIFO with real-time priority (latency-critical, usually requires privileges)
+        ROUND_ROBIN // SCHED_RR with real-time priority (usually requires privileges)
+    };
+
+    /**
+     * Scheduling class that's applied to the thread while it runs a worker.
+     * Only supported on Linux, ignored on other platforms.
+     */
+    struct SchedulingClass {
+        SchedulingPolicy policy = SchedulingPolicy::INHERIT;
+        int nice = 0; // nice value for NORMAL & BATCH policies (-20 to 19)
+        int priority = 0; // real-time priority for FIFO & ROUND_ROBIN policies (1 to 99)
+
+        static SchedulingClass normal(int nice = 0) { return {SchedulingPolicy::NORMAL, nice, 0}; }
+
+        static SchedulingClass batch(int nice = 0) { return {SchedulingPolicy::BATCH, nice, 0}; }
+
+        static SchedulingClass idle() { return {SchedulingPolicy::IDLE, 0, 0}; }
+
+        static SchedulingClass fifo(int priority) { return {SchedulingPolicy::FIFO, 0, priority}; }
+
+        static SchedulingClass round_robin(int priority) { return {SchedulingPolicy::ROUND_ROBIN, 0, priority}; }
+    };
+
+    /**
+     * Applies scheduling class to the calling thread for the lifetime of the scope and restores thread's
+     * previous scheduling on exit, so pooled threads don't keep the class of the previously run worker.
+     * Unprivileged threads (without CAP_SYS_NICE) can only undo demotions (SCHED_IDLE, higher nice value) within
+     * their RLIMIT_NICE, which is 0 by default. Demotions that couldn't be undone are skipped, unless the thread
+     * isn't shared (e.g. thread of an AsyncWorker), so shared & pool threads are never left demoted.
+     * Best effort: failures (e.g. missing privileges for real-time policies) leave the thread's scheduling as is.
+     * Skipped & failed classes are reported by applied().
+     */
+    class ScopedScheduling {
+    public:
+        /**
+         * @param scheduling class to apply
+         * @param shared_thread whether thread runs other work after the scope (e.g. pool thread). If true, class is
+         *   only applied if thread's previous scheduling can be restored.
+         */
+        explicit ScopedScheduling(const SchedulingClass& scheduling, bool shared_thread = true) noexcept {
+#ifdef __linux__
+            if (scheduling.policy == SchedulingPolicy::INHERIT) {
+                return;
+            }
+
+            tid_ = static_cast<pid_t>(syscall(SYS_gettid));
+            if (pthread_getschedparam(pthread_self(), &previous_policy_, &previous_param_) != 0) {
+                return;
+            }
+            errno = 0;
+            previous_nice_ = getpriority(PRIO_PROCESS, tid_);
+            if (errno != 0) {
+                return;
+            }
+            if (shared_thread && !restorable(scheduling)) {
+                return;
+            }
+
+            sched_param param{};
+            param.sched_priority = is_real_time(scheduling.policy) ? scheduling.priority : 0;
+            applied_ = pthread_setschedparam(pthread_self(), native_policy(scheduling.policy), &param) == 0;
+            if (applied_ && has_nice(scheduling.policy)) {
+                // nice value is a per-thread attribute on Linux
+                applied_ = setpriority(PRIO_PROCESS, tid_, scheduling.nice) == 0;
+            }
+            active_ = true;
+#else
+            (void) scheduling;
+            (void) shared_thread;
+#endif
+        }
+
+        ~ScopedScheduling() {
+#ifdef __linux__
+            if (!active_) {
+                return;
+            }
+
+            // policy is restored first, since lowering nice value isn't allowed for SCHED_IDLE threads
+            pthread_setschedparam(pthread_self(), previous_policy_, &previous_param_);
+            setpriority(PRIO_PROCESS, tid_, previous_nice_);
+#endif
+        }
+
+        // non-copyable
+        ScopedScheduling(const ScopedScheduling& other) = delete;
+
+        ScopedScheduling& operator=(const ScopedScheduling& other) = delete;
+
+        /** Returns true if scheduling class was successfully applied (false for INHERIT policy & skipped classes). */
+        [[nodiscard]] bool applied() const noexcept { return applied_; }
+
+    private:
+#ifdef __linux__
+        static bool is_real_time(SchedulingPolicy policy) {
+            return policy == SchedulingPolicy::FIFO || policy == SchedulingPolicy::ROUND_ROBIN;
+        }
+
+        static bool has_nice(SchedulingPolicy policy) {
+            return policy == SchedulingPolicy::NORMAL || policy == SchedulingPolicy::BATCH;
+        }
+
+        /** Returns true if calling thread has CAP_SYS_NICE capability (raising priorities beyond resource limits). */
+        static bool has_sys_nice() noexcept {
+            __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+            __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3]{};
+            if (syscall(SYS_capget, &header, data) != 0) {
+                return false;
+            }
+            return (data[CAP_TO_INDEX(CAP_SYS_NICE)].effective & CAP_TO_MASK(CAP_SYS_NICE)) != 0;
+        }
+
+        /** Returns true if calling thread is allowed to lower it's nice value to passed one (see RLIMIT_NICE). */
+        static bool can_lower_nice_to(int nice) noexcept {
+            rlimit limit{};
+            if (getrlimit(RLIMIT_NICE, &limit) == 0 &&
+                (limit.rlim_cur == RLIM_INFINITY || static_cast<rlim_t>(20 - nice) <= limit.rlim_cur)) {
+                return true;
+            }
+            return has_sys_nice();
+        }
+
+        /** Returns true if calling thread is allowed to set passed real-time priority (see RLIMIT_RTPRIO). */
+        static bool can_set_real_time(int priority) noexcept {
+            rlimit limit{};
+            if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 &&
+                (limit.rlim_cur == RLIM_INFINITY || static_cast<rlim_t>(priority) <= limit.rlim_cur)) {
+                return true;
+            }
+            return has_sys_nice();
+        }
+
+        /** Returns true if thread's previous scheduling could be restored after applying passed class. */
+        bool restorable(const SchedulingClass& scheduling) const noexcept {
+            // real-time policies can always be left, but only re-entered within RLIMIT_RTPRIO
+            if (previous_policy_ == SCHED_FIFO || previous_policy_ == SCHED_RR) {
+                return can_set_real_time(previous_param_.sched_priority);
+            }
+            // leaving SCHED_IDLE & lowering nice value back are limited by RLIMIT_NICE
+            bool demotion = scheduling.policy == SchedulingPolicy::IDLE ||
+                            (has_nice(scheduling.policy) && scheduling.nice > previous_nice_);
+            return !demotion || previous_policy_ == SCHED_IDLE || can_lower_nice_to(previous_nice_);
+        }
+
+        static int native_policy(SchedulingPolicy policy) {
+            switch (policy) {
+                case SchedulingPolicy::BATCH:
+                    return SCHED_BATCH;
+                case SchedulingPolicy::IDLE:
+                    return SCHED_IDLE;
+                case SchedulingPolicy::FIFO:
+                    return SCHED_FIFO;
+                case SchedulingPolicy::ROUND_ROBIN:
+                    return SCHED_RR;
+                default:
+                    return SCHED_OTHER;
+            }
+        }
+
+        pid_t tid_ = 0;
+        int previous_policy_ = SCHED_OTHER;
+        sched_param previous_param_{};
+        int previous_nice_ = 0;
+        bool active_ = false; // previous scheduling was saved & needs to be restored
+#endif
+        bool applied_ = false;
+    };
+}
+
+#endif //WORKERS_MANAGER_SCHEDULING_HPP
@@ -0,0 +1,115 @@
+/** Graceful shutdown of a set of workers with a deadline & escalation, triggerable from signal handlers. */
+
+#ifndef WORKERS_MANAGER_SHUTDOWN_HPP
+#define WORKERS_MANAGER_SHUTDOWN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <worker/worker.hpp>
+
+namespace worker {
+    /** Outcome of shutdown. */
+    struct ShutdownReport {
+        // workers that didn't stop/finish before the deadline (even after escalation). They must not be destroyed.
+        std::vector<std::shared_ptr<BaseWorker>> stragglers;
+
+        [[nodiscard]] bool clean() const noexcept { return stragglers.empty(); }
+    };
+
+    /**
+     * Waits for all workers to finish/stop until the shared deadline.
+     * @return workers that are still not done at the deadline
+     */
+    template<class Clock, class Duration>
+    std::vector<std::shared_ptr<BaseWorker>> wait_all_until(const std::vector<std::shared_ptr<BaseWorker>>& workers,
+                                                            const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::vector<std::shared_ptr<BaseWorker>> not_done;
+        for (const auto& worker: workers) {
+            if (!worker->wait_until(deadline)) {
+                not_done.push_back(worker);
+            }
+        }
+        return not_done;
+    }
+
+    /**
+     * Stops all workers at once (stop is requested on every worker before waiting on any) and waits for them
+     * until the deadline. Workers that are still running at the deadline are escalated (if escalate is given)
+     * and waited on for another escalation_timeout.
+     * @param escalate called for every straggler, e.g. to hard-cancel it's blocking I/O (close sockets, files, ...)
+     * @return report with workers that didn't stop
+     */
+    template<class Clock, class Duration>
+    ShutdownReport shutdown(const std::vector<std::shared_ptr<BaseWorker>>& workers,
+                            const std::chrono::time_point<Clock, Duration>& deadline,
+                            const std::function<void(BaseWorker&)>& escalate = {},
+                            std::chrono::steady_clock::duration escalation_timeout = std::chrono::seconds(1)) {
+        for (const auto& worker: workers) {
+            worker->request_stop();
+        }
+
+        ShutdownReport report;
+        report.stragglers = wait_all_until(workers, deadline);
+        if (report.stragglers.empty() || !escalate) {
+            return report;
+        }
+
+        for (const auto& straggler: report.stragglers) {
+            escalate(*straggler);
+        }
+        report.stragglers = wait_all_until(report.stragglers, std::chrono::steady_clock::now() + escalation_timeout);
+        return report;
+    }
+
+    /**
+     * Process-wide shutdown trigger that can be set from signal handlers (e.g. SIGTERM).
+     * Triggering is async-signal-safe (lock-free atomic store), shutdown itself is then done by a regular thread
+     * that polls triggered() or waits with wait_for().
+     */
+    class ShutdownSignal {
+        static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "shutdown trigger must be lock-free to be async-signal-safe");
+
+    public:
+        ShutdownSignal() = delete;
+
+        /** Triggers shutdown. Async-signal-safe. */
+        static void trigger() noexcept { triggered_.store(true); }
+
+        /** Returns true if shutdown was triggered. Async-signal-safe. */
+        [[nodiscard]] static bool triggered() noexcept { return triggered_.load(); }
+
+        /** Installs trigger as the handler of passed signals (SIGINT & SIGTERM by default). */
+        static void install(std::initializer_list<int> signals = {SIGINT, SIGTERM}) {
+            for (auto signal: signals) {
+                std::signal(signal, &ShutdownSignal::handle_signal);
+            }
+        }
+
+        /**
+         * Waits (by polling) until shutdown is triggered or timeout passes.
+         * @return true if shutdown was triggered
+         */
+        template<class Rep, class Period>
+        static bool wait_for(const std::chrono::duration<Rep, Period>& timeout,
+                             std::chrono::milliseconds poll_interval = std::chrono::milliseconds(10)) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!triggered() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(poll_interval);
+            }
+            return triggered();
+        }
+
+    private:
+        static void handle_signal(int) { trigger(); }
+
+        inline static std::atomic<bool> triggered_ = false;
+    };
+}
+
+#endif //WORKERS_MANAGER_SHUTDOWN_HPP
@@ -0,0 +1,161 @@
+/** Slab allocator of fixed-size blocks with per-thread slabs & lock-free free lists (see SlabAllocator). */
+
+#ifndef WORKERS_MANAGER_SLAB_HPP
+#define WORKERS_MANAGER_SLAB_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace worker {
+    inline constexpr std::size_t SLAB_SIZE = 64 * 1024;
+    inline constexpr std::size_t MAX_SLAB_BLOCK_SIZE = SLAB_SIZE / 8;
+    inline constexpr std::size_t SLAB_BLOCK_ALIGNMENT = 16;
+
+    /**
+     * Allocator of fixed-size blocks. Blocks are carved from 64 KiB slabs owned by thread caches.
+     * Each thread allocates from it's own cache's free list without synchronization. Blocks freed by other threads
+     * are pushed to the owning cache's lock-free remote free list, which the owner takes over once it's local list
+     * is empty. Caches of exited threads are adopted by new threads. Memory is never returned to the OS, so
+     * allocation & deallocation don't call malloc once enough slabs were carved (steady state).
+     * @tparam BlockSize size of blocks, multiple of 16 (blocks are 16-byte aligned)
+     */
+    template<std::size_t BlockSize>
+    class SlabAllocator {
+    public:
+        static_assert(BlockSize > 0 && BlockSize % SLAB_BLOCK_ALIGNMENT == 0, "block size must be a multiple of 16");
+        static_assert(BlockSize <= MAX_SLAB_BLOCK_SIZE, "blocks are too large for slabs");
+
+        /**
+         * Allocates a block. Thread-safe.
+         * @throws std::bad_alloc if a new slab can't be allocated
+         */
+        static void* allocate() {
+            auto& cache = thread_cache();
+            if (cache.local == nullptr) {
+                // blocks freed by other threads
+                cache.local = cache.remote.exchange(nullptr, std::memory_order_acquire);
+            }
+            if (cache.local == nullptr) {
+                carve_slab(cache);
+            }
+            return std::exchange(cache.local, cache.local->next);
+        }
+
+        /** Returns block to the cache it was allocated from. Thread-safe & lock-free. */
+        static void deallocate(void* block) noexcept {
+            auto* free_block = static_cast<FreeBlock*>(block);
+            auto* owner = slab_of(block)->owner;
+
+            if (owner == current_cache_) {
+                free_block->next = owner->local;
+                owner->local = free_block;
+                return;
+            }
+
+            // owner's remote list is only ever emptied as a whole, so pushing is ABA-safe
+            free_block->next = owner->remote.load(std::memory_order_relaxed);
+            while (!owner->remote.compare_exchange_weak(free_block->next, free_block, std::memory_order_release,
+                                                        std::memory_order_relaxed)) {
+            }
+        }
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        struct Cache {
+            FreeBlock* local = nullptr; // only accessed by the owning thread
+            std::atomic<FreeBlock*> remote = nullptr; // freed by other threads
+        };
+
+        struct alignas(SLAB_BLOCK_ALIGNMENT) SlabHeader {
+            Cache* owner;
+        };
+
+        /** Registers calling thread's cache, hands it over to other threads once the thread exits. */
+        struct CacheOwnership {
+            CacheOwnership() : cache(adopt_cache()) { current_cache_ = cache; }
+
+            ~CacheOwnership() {
+                current_cache_ = nullptr;
+                std::lock_guard<std::mutex> lock(orphans_m());
+                orphans().push_back(cache);
+            }
+
+            Cache* cache;
+        };
+
+        /** Returns cache of the calling thread. */
+        static Cache& thread_cache() {
+            if (current_cache_ == nullptr) {
+                static thread_local CacheOwnership ownership;
+                // thread is exiting (ownership already destroyed), cache is never handed over
+                if (current_cache_ == nullptr) {
+                    current_cache_ = new Cache();
+                }
+            }
+            return *current_cache_;
+        }
+
+        /** Returns cache of an exited thread or a new cache. Caches are never destroyed (blocks refer to them). */
+        static Cache* adopt_cache() {
+            std::lock_guard<std::mutex> lock(orphans_m());
+            if (orphans().empty()) {
+                return new Cache();
+            }
+            auto* cache = orphans().back();
+            orphans().pop_back();
+            return cache;
+        }
+
+        /** Allocates a new slab for passed cache & adds all of it's blocks to the cache's local list. */
+        static void carve_slab(Cache& cache) {
+            void* memory = std::aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+            if (memory == nullptr) {
+                throw std::bad_alloc();
+            }
+            auto* slab = static_cast<char*>(memory);
+            new(slab) SlabHeader{&cache};
+
+            // blocks follow the header, pushed in reverse so they're allocated in address order
+            constexpr std::size_t n_blocks = (SLAB_SIZE - sizeof(SlabHeader)) / BlockSize;
+            for (std::size_t i = n_blocks; i > 0; --i) {
+                cache.local = new(slab + sizeof(SlabHeader) + (i - 1) * BlockSize) FreeBlock{cache.local};
+            }
+        }
+
+        static SlabHeader* slab_of(void* block) noexcept {
+            return reinterpret_cast<SlabHeader*>(reinterpret_cast<std::uintptr_t>(block) & ~(SLAB_SIZE - 1));
+        }
+
+        static std::vector<Cache*>& orphans() {
+            static std::vector<Cache*> orphans;
+            return orphans;
+        }
+
+        static std::mutex& orphans_m() {
+            static std::mutex m;
+            return m;
+        }
+
+        static inline thread_local Cache* current_cache_ = nullptr; // cache of the calling thread
+    };
+
+    /** SlabAllocator for objects of type T (blocks are shared by all types of the same rounded size). */
+    template<class T>
+    using slab_allocator_t = SlabAllocator<(sizeof(T) + SLAB_BLOCK_ALIGNMENT - 1) / SLAB_BLOCK_ALIGNMENT *
+                                           SLAB_BLOCK_ALIGNMENT>;
+
+    /** Whether objects of type T can be allocated with SlabAllocator (small enough & not over-aligned). */
+    template<class T>
+    inline constexpr bool slab_allocatable_v = sizeof(T) <= MAX_SLAB_BLOCK_SIZE && alignof(T) <= SLAB_BLOCK_ALIGNMENT;
+}
+
+#endif //WORKERS_MANAGER_SLAB_HPP
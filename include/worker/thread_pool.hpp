@@ -0,0 +1,99 @@
+/** Fixed size thread pool used by the library for running work on behalf of workers. */
+
+#ifndef WORKERS_MANAGER_THREAD_POOL_HPP
+#define WORKERS_MANAGER_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace worker {
+    /**
+     * Simple thread pool with a fixed number of threads and a FIFO task queue.
+     * Tasks must not throw (std::terminate is called otherwise).
+     * Destructor runs all the tasks that are still queued and joins the threads.
+     */
+    class ThreadPool {
+    public:
+        /** @param n_threads number of pool threads (at least 1) */
+        explicit ThreadPool(std::size_t n_threads = default_size()) {
+            n_threads = std::max<std::size_t>(n_threads, 1);
+            threads_.reserve(n_threads);
+            for (std::size_t i = 0; i < n_threads; ++i) {
+                threads_.emplace_back(&ThreadPool::thread_loop, this);
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(tasks_m_);
+                stop_ = true;
+            }
+            tasks_cv_.notify_all();
+
+            for (auto& thread: threads_) {
+                thread.join();
+            }
+        }
+
+        // non-copyable
+        ThreadPool(const ThreadPool& other) = delete;
+
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        /** Queues task for execution on one of the pool threads. Thread-safe. */
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(tasks_m_);
+                tasks_.push_back(std::move(task));
+            }
+            tasks_cv_.notify_one();
+        }
+
+        /** Returns number of pool threads */
+        [[nodiscard]] std::size_t size() const noexcept { return threads_.size(); }
+
+        /** Returns number of pool threads that's used by default (number of hardware threads). */
+        [[nodiscard]] static std::size_t default_size() noexcept {
+            return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        /** Returns library's default pool (lazily constructed with default_size() threads). */
+        static ThreadPool& default_pool() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+    private:
+        /** Main loop of a pool thread. Runs tasks until the pool is destroyed and the queue is empty. */
+        void thread_loop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(tasks_m_);
+                    tasks_cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                    if (tasks_.empty()) { // stopped & drained
+                        return;
+                    }
+
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> threads_;
+
+        std::deque<std::function<void()>> tasks_;
+        bool stop_ = false; // set on destruction
+        std::mutex tasks_m_; // mutex for accessing task queue
+        std::condition_variable tasks_cv_; // conditional variable for notifying pool threads of new tasks
+    };
+}
+
+#endif //WORKERS_MANAGER_THREAD_POOL_HPP
@@ -0,0 +1,141 @@
+/** CPU topology utilities (sockets, thread pinning). Linux only, other platforms report a single socket. */
+
+#ifndef WORKERS_MANAGER_TOPOLOGY_HPP
+#define WORKERS_MANAGER_TOPOLOGY_HPP
+
+#ifdef __linux__
+
+#include <pthread.h>
+#include <sched.h>
+
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace worker::topology {
+    /** Returns socket (physical package) id of every CPU, indexed by CPU id. Unknown sockets are reported as 0. */
+    inline std::vector<int> cpu_sockets() {
+        std::vector<int> sockets(std::max(std::thread::hardware_concurrency(), 1u), 0);
+#ifdef __linux__
+        for (std::size_t cpu = 0; cpu < sockets.size(); ++cpu) {
+            std::ifstream package_id(
+                    "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/physical_package_id");
+            package_id >> sockets[cpu];
+        }
+#endif
+        return sockets;
+    }
+
+    /** Returns ids of sockets, in increasing order. */
+    inline std::vector<int> sockets() {
+        auto sockets = cpu_sockets();
+        std::sort(sockets.begin(), sockets.end());
+        sockets.erase(std::unique(sockets.begin(), sockets.end()), sockets.end());
+        return sockets;
+    }
+
+    /**
+     * Pins calling thread to the CPUs of passed socket.
+     * @return true on success (always false on platforms other than Linux)
+     */
+    inline bool pin_to_socket(int socket) {
+#ifdef __linux__
+        auto sockets = cpu_sockets();
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (std::size_t cpu = 0; cpu < sockets.size(); ++cpu) {
+            if (sockets[cpu] == socket) {
+                CPU_SET(cpu, &cpu_set);
+            }
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+        (void) socket;
+        return false;
+#endif
+    }
+
+    /** Returns CPU the calling thread is running on, -1 if unknown. */
+    inline int current_cpu() noexcept {
+#ifdef __linux__
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+    /**
+     * Soft affinity of a worker to the CPU it last ran on, used to keep it's cache working set warm when it resumes.
+     * Resumed worker's thread is moved back to it's last CPU, unless another sticky worker of the process claimed it
+     * (then OS places it as usual). Thread isn't left pinned - it's affinity is restored right after the move,
+     * so OS load balancing still applies. Claim is released when the worker leaves the CPU again.
+     * Must only be used from the thread running the worker. Linux only, no-op on other platforms.
+     */
+    class StickyAffinity {
+    public:
+        StickyAffinity() = default;
+
+        // non-copyable
+        StickyAffinity(const StickyAffinity& other) = delete;
+
+        StickyAffinity& operator=(const StickyAffinity& other) = delete;
+
+        /** Remembers the CPU the calling thread runs on (e.g. before worker pauses) & releases it's claim. */
+        void leave() noexcept {
+            release();
+            cpu_ = current_cpu();
+        }
+
+        /** Moves calling thread to the remembered CPU if it's not claimed by another sticky worker. */
+        void resume() noexcept {
+#ifdef __linux__
+            if (cpu_ < 0 || static_cast<std::size_t>(cpu_) >= n_cpus() || claims()[cpu_].exchange(true)) {
+                return;
+            }
+            claimed_ = cpu_;
+
+            cpu_set_t allowed;
+            if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0 ||
+                !CPU_ISSET(claimed_, &allowed)) {
+                return;
+            }
+            // changing affinity moves the thread before the call returns, so it can be restored right away
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(claimed_, &cpu_set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0) {
+                pthread_setaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+            }
+#endif
+        }
+
+        /** Releases claimed CPU (e.g. when worker is done). */
+        void release() noexcept {
+            if (claimed_ < 0) {
+                return;
+            }
+            claims()[claimed_] = false;
+            claimed_ = -1;
+        }
+
+    private:
+        static std::size_t n_cpus() noexcept { return std::max(std::thread::hardware_concurrency(), 1u); }
+
+        /** Process-wide claims of CPUs by resumed sticky workers, indexed by CPU id. */
+        static std::atomic<bool>* claims() {
+            static std::unique_ptr<std::atomic<bool>[]> claims(new std::atomic<bool>[n_cpus()]());
+            return claims.get();
+        }
+
+        int cpu_ = -1; // CPU worker last ran on
+        int claimed_ = -1; // CPU claimed by the resumed worker
+    };
+}
+
+#endif //WORKERS_MANAGER_TOPOLOGY_HPP
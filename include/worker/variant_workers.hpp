@@ -0,0 +1,155 @@
+/** Container of workers of a closed set of types, stored inline in a contiguous array (see VariantWorkers). */
+
+#ifndef WORKERS_MANAGER_VARIANT_WORKERS_HPP
+#define WORKERS_MANAGER_VARIANT_WORKERS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <worker/worker.hpp>
+
+namespace worker {
+    /**
+     * Fixed-capacity container of workers whose types are known in advance (e.g. AsyncWorker instantiations of
+     * an application's job functions). Workers are constructed in place in a contiguous array of variants, so there's
+     * no per-worker heap allocation or pointer indirection & scans over all workers (status, progress, ...) are
+     * cache friendly. Typed access (e.g. result) is done through visitation.
+     * Workers are never moved (capacity doesn't grow) & are destroyed with the container (see AsyncWorker destructor).
+     * Adding workers must be synchronized with other accesses to the container, workers themselves are thread-safe.
+     * @tparam Workers worker types, derived from BaseWorker
+     */
+    template<class... Workers>
+    class VariantWorkers {
+        static_assert(sizeof...(Workers) > 0, "at least one worker type is required");
+        static_assert((std::is_base_of_v<BaseWorker, Workers> && ...), "workers must derive from BaseWorker");
+
+        // empty slots hold monostate
+        using slot_t = std::variant<std::monostate, Workers...>;
+
+    public:
+        /** @param capacity maximum number of workers */
+        explicit VariantWorkers(std::size_t capacity) : slots_(new slot_t[capacity]), capacity_(capacity) {}
+
+        // non-copyable
+        VariantWorkers(const VariantWorkers& other) = delete;
+
+        VariantWorkers& operator=(const VariantWorkers& other) = delete;
+
+        /**
+         * Constructs worker of type Worker in the next slot, from passed constructor arguments.
+         * Worker types can repeat (e.g. functions with the same signature).
+         * @return constructed worker, it's index is the previous size()
+         * @throws std::length_error if container is full
+         */
+        template<class Worker, class... CArgs>
+        Worker& emplace(CArgs&& ... args) {
+            static_assert((std::is_same_v<Worker, Workers> || ...), "worker type isn't one of container's types");
+            if (size_ == capacity_) {
+                throw std::length_error("Variant workers container is full");
+            }
+            auto& worker = slots_[size_].template emplace<index_of<Worker>()>(std::forward<CArgs>(args)...);
+            ++size_;
+            return worker;
+        }
+
+        /** Returns worker with passed index as a BaseWorker (control, status, ...). No virtual dispatch is involved. */
+        BaseWorker& operator[](std::size_t index) {
+            return visit(index, [](BaseWorker& worker) -> BaseWorker& { return worker; });
+        }
+
+        const BaseWorker& operator[](std::size_t index) const {
+            return visit(index, [](const BaseWorker& worker) -> const BaseWorker& { return worker; });
+        }
+
+        /**
+         * Calls visitor with worker with passed index, as it's concrete type (see std::visit).
+         * @throws std::out_of_range if there's no worker with passed index
+         */
+        template<class Visitor>
+        decltype(auto) visit(std::size_t index, Visitor&& visitor) {
+            return std::visit(Visit<Visitor&&, false>{std::forward<Visitor>(visitor)}, at(index));
+        }
+
+        template<class Visitor>
+        decltype(auto) visit(std::size_t index, Visitor&& visitor) const {
+            return std::visit(Visit<Visitor&&, true>{std::forward<Visitor>(visitor)}, at(index));
+        }
+
+        /** Calls visitor with every worker in order of construction, as it's concrete type. */
+        template<class Visitor>
+        void for_each(Visitor&& visitor) {
+            for (std::size_t i = 0; i < size_; ++i) {
+                std::visit(Visit<Visitor&, false>{visitor}, slots_[i]);
+            }
+        }
+
+        template<class Visitor>
+        void for_each(Visitor&& visitor) const {
+            for (std::size_t i = 0; i < size_; ++i) {
+                std::visit(Visit<Visitor&, true>{visitor}, slots_[i]);
+            }
+        }
+
+        /** Returns number of constructed workers. */
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+        /** Returns maximum number of workers. */
+        [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    private:
+        /**
+         * Forwards workers to the visitor, which must return the same type for all workers (see std::visit).
+         * Empty slots are never visited (they're past the size).
+         */
+        template<class Visitor, bool Const>
+        struct Visit {
+            using first_t = std::tuple_element_t<0, std::tuple<Workers...>>;
+            using result_t = std::invoke_result_t<Visitor, std::conditional_t<Const, const first_t, first_t>&>;
+            using empty_t = std::conditional_t<Const, const std::monostate, std::monostate>;
+
+            result_t operator()(empty_t&) const { throw std::logic_error("Empty worker slot was visited"); }
+
+            template<class Worker>
+            result_t operator()(Worker& worker) const { return std::forward<Visitor>(visitor)(worker); }
+
+            Visitor visitor;
+        };
+
+        /** Returns variant index of the first occurrence of passed worker type. */
+        template<class Worker>
+        static constexpr std::size_t index_of() {
+            constexpr bool matches[] = {std::is_same_v<Worker, Workers>...};
+            std::size_t index = 0;
+            while (!matches[index]) {
+                ++index;
+            }
+            return index + 1; // monostate is first
+        }
+
+        slot_t& at(std::size_t index) {
+            if (index >= size_) {
+                throw std::out_of_range("No worker with index " + std::to_string(index));
+            }
+            return slots_[index];
+        }
+
+        const slot_t& at(std::size_t index) const {
+            if (index >= size_) {
+                throw std::out_of_range("No worker with index " + std::to_string(index));
+            }
+            return slots_[index];
+        }
+
+        std::unique_ptr<slot_t[]> slots_;
+        const std::size_t capacity_;
+        std::size_t size_ = 0; // number of constructed workers, they're at the front
+    };
+}
+
+#endif //WORKERS_MANAGER_VARIANT_WORKERS_HPP
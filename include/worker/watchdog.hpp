@@ -0,0 +1,159 @@
+/** Watchdog that detects stalled (hung) workers - running workers that haven't yielded for too long. */
+
+#ifndef WORKERS_MANAGER_WATCHDOG_HPP
+#define WORKERS_MANAGER_WATCHDOG_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <worker/worker.hpp>
+
+namespace worker {
+    /**
+     * Single thread that periodically scans all watched workers and flags running workers that haven't yielded
+     * within the configured threshold. Such workers would block pause & stop calls. Workers that haven't started
+     * yet (e.g. queued pooled workers) aren't watched until they start.
+     * Yield times are derived from changes of BaseWorker::yield_count observed by the watchdog,
+     * so the yield fast path doesn't need to read the clock. Stalls are detected with at most one period of delay.
+     */
+    class Watchdog {
+    public:
+        using clock_t = std::chrono::steady_clock;
+
+        /**
+         * Function called (from the watchdog thread) once for every detected stall.
+         * Can be used to capture diagnostics (e.g. dump stacks) of the stalled worker.
+         */
+        using stall_handler_t = std::function<void(const BaseWorker& worker, clock_t::duration stalled_for)>;
+
+        /**
+         * Starts watchdog thread.
+         * @param threshold duration without yields after which running worker is considered stalled
+         * @param handler called for every detected stall, prints a warning to standard error by default
+         * @param period scanning period, a quarter of the threshold by default
+         */
+        explicit Watchdog(clock_t::duration threshold, stall_handler_t handler = &Watchdog::print_stall,
+                          clock_t::duration period = clock_t::duration::zero()) :
+                threshold_(threshold),
+                period_(period > clock_t::duration::zero() ? period : std::max<clock_t::duration>(
+                        threshold / 4, std::chrono::milliseconds(1))),
+                handler_(std::move(handler)) {
+            thread_ = std::thread(&Watchdog::thread_loop, this);
+        }
+
+        /** Stops watchdog thread. */
+        ~Watchdog() {
+            {
+                std::lock_guard<std::mutex> lock(watched_m_);
+                stop_ = true;
+            }
+            watched_cv_.notify_all();
+            thread_.join();
+        }
+
+        // non-copyable
+        Watchdog(const Watchdog& other) = delete;
+
+        Watchdog& operator=(const Watchdog& other) = delete;
+
+        /** Starts watching worker. Watchdog doesn't extend worker's lifetime. Thread-safe. */
+        void watch(const std::shared_ptr<BaseWorker>& worker) {
+            std::lock_guard<std::mutex> lock(watched_m_);
+            watched_.push_back({worker, worker->yield_count(), clock_t::now(), false});
+        }
+
+        /** Returns watched workers that are currently considered stalled. Thread-safe. */
+        [[nodiscard]] std::vector<std::shared_ptr<BaseWorker>> stalled_workers() const {
+            std::lock_guard<std::mutex> lock(watched_m_);
+            std::vector<std::shared_ptr<BaseWorker>> stalled;
+            for (const auto& watched: watched_) {
+                auto worker = watched.worker.lock();
+                if (watched.stalled && worker) {
+                    stalled.push_back(std::move(worker));
+                }
+            }
+            return stalled;
+        }
+
+        /** Default stall handler, prints a warning to standard error. */
+        static void print_stall(const BaseWorker& worker, clock_t::duration stalled_for) {
+            auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(stalled_for).count();
+            std::cerr << "Watchdog: worker " << worker.id() << " (" << worker.name() << ") hasn't yielded for "
+                      << seconds << "s" << std::endl;
+        }
+
+    private:
+        struct WatchedWorker {
+            std::weak_ptr<BaseWorker> worker;
+            std::uint64_t yield_count; // last observed yield count
+            clock_t::time_point last_yield; // when the last change of yield count was observed
+            bool stalled; // stall has been detected (& reported)
+        };
+
+        /** Scans workers every period until stopped. */
+        void thread_loop() {
+            std::unique_lock<std::mutex> lock(watched_m_);
+            while (!watched_cv_.wait_for(lock, period_, [this]() { return stop_; })) {
+                auto stalls = scan();
+
+                // handlers are called without holding the lock (they might call watch)
+                lock.unlock();
+                for (const auto&[worker, stalled_for]: stalls) {
+                    handler_(*worker, stalled_for);
+                }
+                lock.lock();
+            }
+        }
+
+        /** Updates watched workers & returns newly detected stalls. Must be called under watched_m_ lock. */
+        std::vector<std::pair<std::shared_ptr<BaseWorker>, clock_t::duration>> scan() {
+            std::vector<std::pair<std::shared_ptr<BaseWorker>, clock_t::duration>> stalls;
+            auto now = clock_t::now();
+
+            for (auto& watched: watched_) {
+                auto worker = watched.worker.lock();
+                if (!worker) {
+                    continue;
+                }
+
+                auto yield_count = worker->yield_count();
+                // queued, paused & terminal workers can't be stalled
+                if (yield_count != watched.yield_count || !worker->started() || worker->status() != Status::RUNNING) {
+                    watched.yield_count = yield_count;
+                    watched.last_yield = now;
+                    watched.stalled = false;
+                }
+                else if (!watched.stalled && now - watched.last_yield >= threshold_) {
+                    watched.stalled = true;
+                    stalls.emplace_back(std::move(worker), now - watched.last_yield);
+                }
+            }
+
+            // forget destroyed workers
+            watched_.erase(std::remove_if(watched_.begin(), watched_.end(), [](const WatchedWorker& watched) {
+                return watched.worker.expired();
+            }), watched_.end());
+
+            return stalls;
+        }
+
+        const clock_t::duration threshold_;
+        const clock_t::duration period_;
+        const stall_handler_t handler_;
+
+        std::vector<WatchedWorker> watched_;
+        bool stop_ = false; // set on destruction
+        mutable std::mutex watched_m_; // mutex for accessing watched workers
+        std::condition_variable watched_cv_; // conditional variable for waking watchdog thread on destruction
+        std::thread thread_;
+    };
+}
+
+#endif //WORKERS_MANAGER_WATCHDOG_HPP
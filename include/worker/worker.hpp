@@ -1,20 +1,147 @@
 #ifndef WORKERS_MANAGER_WORKER_HPP
 #define WORKERS_MANAGER_WORKER_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <atomic>
+#include <chrono>
 #include <future>
 #include <utility>
 #include <functional>
 #include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <thread>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <worker/local_storage.hpp>
+#include <worker/perf_counters.hpp>
+#include <worker/runtime_model.hpp>
+#include <worker/scheduling.hpp>
+#include <worker/topology.hpp>
 
 namespace worker {
     enum class Status {
-        RUNNING, PAUSED, STOPPED, FINISHED
+        RUNNING, PAUSED, STOPPED, FINISHED,
+        SUSPENDED // running, but it's thread runs other work on top of it (see BaseWorker::suspend)
     };
 
+    // unique (per process) worker identifier, 0 is reserved for "no worker"
+    using worker_id_t = std::uint64_t;
+
+    class BaseWorker;
+
+    // key/value labels of a worker (e.g. tenant, priority class)
+    using labels_t = std::map<std::string, std::string>;
+
+    /** Stage of worker's execution (e.g. load, compute, write), see WorkerOptions::phases. */
+    struct WorkerPhase {
+        std::string name;
+        double weight = 1; // share of the overall progress, relative to other phases' weights
+    };
+
+    /** Optional worker configuration, passed on construction. */
+    struct WorkerOptions {
+        std::string name; // optional name for the worker
+        SchedulingClass scheduling; // OS scheduling class of the thread while it runs the worker (Linux only)
+        std::string type; // worker type used to aggregate statistics (e.g. function name), name is used if empty
+        bool perf_counters = false; // measure hardware performance counters of the worker (Linux only)
+        std::uint64_t size = 0; // job size (e.g. number of elements), runtimes are predicted per type & size
+        std::optional<std::chrono::steady_clock::time_point> deadline; // optional time by which worker should finish
+        bool sticky_affinity = false; // resumed worker returns to the CPU it last ran on if it's free (Linux only)
+        bool track_progress = true; // if false, yields don't publish progress (it's 0 until worker finishes)
+        // optional weighted phases, yields then report progress within the current phase (see this_worker::phase)
+        std::vector<WorkerPhase> phases;
+        labels_t labels; // labels for fleet queries (see WorkerRegistry)
+    };
+
+    /** Point-in-time view of a worker, for monitoring. */
+    struct WorkerSnapshot {
+        worker_id_t id = 0;
+        std::string name;
+        Status status = Status::RUNNING;
+        double progress = 0; // overall progress, in the 0-1 range
+        std::string phase; // name of the current phase (empty if worker has no phases)
+    };
+
+    /**
+     * Thrown by yield-aware utilities (e.g. YieldIterator) when worker has been requested to stop.
+     * Unwinds worker's stack as a controlled early exit from code that can't return early (e.g. standard algorithms).
+     * Worker functions can catch it to return partial results. Otherwise it's rethrown by AsyncWorker::result.
+     */
+    class WorkerStopped : public std::runtime_error {
+    public:
+        WorkerStopped() : std::runtime_error("worker has been stopped") {}
+    };
+
+    /**
+     * Functions for controlling the worker that's running on the calling thread, without passing yield function around.
+     * Allows deep library code (e.g. sort algorithms, parsers) to participate in pausing & stopping.
+     * When called outside of a worker, functions are no-ops (yield always returns true).
+     */
+    namespace this_worker {
+        /** Same as BaseWorker::yield, for the worker running on the calling thread. */
+        [[nodiscard]] inline bool yield(double progress);
+
+        /** Publishes progress of the worker running on the calling thread, without pausing/stopping checks. */
+        inline void progress(double progress);
+
+        /**
+         * Same as yield, but only for control (pausing & stopping) - progress isn't published. Cheapest check for
+         * workers without meaningful progress (e.g. recursive algorithms). Pooled workers aren't preempted by it.
+         */
+        [[nodiscard]] inline bool should_continue();
+
+        /** Returns true if stop has been requested for the worker running on the calling thread. */
+        [[nodiscard]] inline bool stop_requested() noexcept;
+
+        /**
+         * Enters phase with passed index (see WorkerOptions::phases) of the worker running on the calling thread.
+         * Progress of subsequent yields is progress within the phase. No-op if worker has no phases.
+         * @throws std::out_of_range if worker doesn't have a phase with passed index
+         */
+        inline void phase(std::size_t index);
+
+        /** Returns id of the worker running on the calling thread or 0 if there's none. */
+        [[nodiscard]] inline worker_id_t id() noexcept;
+    }
+
+    namespace detail {
+        // worker that's running on the current thread (if any)
+        inline thread_local BaseWorker* current_worker = nullptr;
+
+        /**
+         * Sets current thread's worker (& it's local storage) for the lifetime of the scope.
+         * Restores previous one on exit (nestable).
+         */
+        class CurrentWorkerScope {
+        public:
+            inline explicit CurrentWorkerScope(BaseWorker* worker) noexcept;
+
+            ~CurrentWorkerScope() {
+                current_worker = previous_;
+                current_local_storage = previous_storage_;
+            }
+
+            CurrentWorkerScope(const CurrentWorkerScope& other) = delete;
+
+            CurrentWorkerScope& operator=(const CurrentWorkerScope& other) = delete;
+
+        private:
+            BaseWorker* previous_;
+            LocalStorage* previous_storage_;
+        };
+    }
+
     /**
      * Abstract base class for worker that can be paused, restarted and stopped.
      * Instances must be modified (paused, restarted, stopped) from a single thread.
@@ -27,6 +154,19 @@ namespace worker {
         /** @param name: Optional name for this worker. */
         explicit BaseWorker(std::string name) : name_(std::move(name)) {};
 
+        /** @param options: Worker configuration (name, scheduling class, ...). */
+        explicit BaseWorker(WorkerOptions options) : name_(std::move(options.name)),
+                                                     type_(std::move(options.type)),
+                                                     scheduling_(options.scheduling),
+                                                     perf_counters_(options.perf_counters),
+                                                     size_(options.size),
+                                                     deadline_(options.deadline),
+                                                     sticky_affinity_(options.sticky_affinity),
+                                                     track_progress_(options.track_progress),
+                                                     phases_(std::move(options.phases)),
+                                                     phase_starts_(phase_starts(phases_)),
+                                                     labels_(std::move(options.labels)) {};
+
         /**
          * Pure virtual destructor declaration to mark an abstract class.
          * Worker isn't stopped or waited on in default implementation (noexcept).
@@ -39,21 +179,98 @@ namespace worker {
 
         BaseWorker& operator=(const BaseWorker& other) = delete;
 
+        /** Returns worker's unique id. Thread-safe. */
+        [[nodiscard]] worker_id_t id() const noexcept { return id_; }
+
         /** Returns worker name (can be empty). Thread-safe. */
         [[nodiscard]] std::string name() const noexcept { return name_; }
 
+        /** Returns worker type used to aggregate statistics (defaults to name). Thread-safe. */
+        [[nodiscard]] const std::string& type() const noexcept { return type_.empty() ? name_ : type_; }
+
+        /**
+         * Returns hardware performance counters accumulated over worker's execution intervals so far
+         * (updated when worker pauses & when it's done). Zeros if counters are disabled or unavailable. Thread-safe.
+         */
+        [[nodiscard]] PerfSample perf_sample() const {
+            std::lock_guard<std::mutex> lock(status_m_);
+            return perf_sample_;
+        }
+
+        /** Returns job size used to predict worker's runtime (see RuntimeModel). Thread-safe. */
+        [[nodiscard]] std::uint64_t size() const noexcept { return size_; }
+
+        /** Returns time by which worker should finish, if it has a deadline. Thread-safe. */
+        [[nodiscard]] const std::optional<std::chrono::steady_clock::time_point>& deadline() const noexcept {
+            return deadline_;
+        }
+
+        /** Returns true if worker finished after it's deadline. Thread-safe. */
+        [[nodiscard]] bool deadline_missed() const {
+            std::lock_guard<std::mutex> lock(status_m_);
+            return deadline_missed_;
+        }
+
+        /** Returns scheduling class of the thread(s) running this worker. Thread-safe. */
+        [[nodiscard]] const SchedulingClass& scheduling() const noexcept { return scheduling_; }
+
+        /**
+         * Returns true once worker has started running (e.g. queued pooled workers haven't, although they report
+         * running status). Lock-free.
+         */
+        [[nodiscard]] bool started() const noexcept { return has_started_.load(std::memory_order_acquire); }
+
         /** Returns worker status (e.g. running, paused, ...). Thread-safe. */
         [[nodiscard]] Status status() const {
             std::lock_guard<std::mutex> lock(status_m_);
             return status_;
         }
 
-        /** Returns worker's progress, in the 0-1 range (0%-100%). Thread-safe. */
+        /**
+         * Returns worker's progress, in the 0-1 range (0%-100%). Thread-safe.
+         * Progress of workers that don't track it is 0 until they finish.
+         */
         [[nodiscard]] double progress() const noexcept { return progress_; }
 
+        /** Returns worker's labels. Thread-safe. */
+        [[nodiscard]] const labels_t& labels() const noexcept { return labels_; }
+
+        /** Returns worker's phases (empty if it has none). Thread-safe. */
+        [[nodiscard]] const std::vector<WorkerPhase>& phases() const noexcept { return phases_; }
+
+        /** Returns index of worker's current phase (0 if it has no phases). Lock-free. */
+        [[nodiscard]] std::size_t phase() const noexcept { return phase_.load(std::memory_order_relaxed); }
+
+        /** Returns worker's id, name, status, progress & phase. Thread-safe. */
+        [[nodiscard]] WorkerSnapshot snapshot() const;
+
+        /**
+         * Returns number of times worker's thread resumed (after pause) on a different CPU than it paused on
+         * (helper threads yielding on worker's behalf aren't counted). Lock-free.
+         */
+        [[nodiscard]] std::uint64_t migrations() const noexcept {
+            return migrations_.load(std::memory_order_relaxed);
+        }
+
         /**
-         * Pauses worker (blocking call)
-         * @throws std::logic_error if worker is not running when the method is called
+         * Returns number of changes of worker's status, phase & progress (in PROGRESS_BUCKETS steps). Used to detect
+         * changed workers (see WorkerRegistry::snapshot) - only changes are meaningful. Lock-free.
+         */
+        [[nodiscard]] std::uint64_t change_count() const noexcept {
+            return change_count_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Returns number of yields performed by this worker (approximate if yielded from multiple threads).
+         * Used to detect stalled workers (see Watchdog) - only changes are meaningful. Lock-free.
+         */
+        [[nodiscard]] std::uint64_t yield_count() const noexcept {
+            return yield_count_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Pauses worker (blocking call). Suspended worker is paused immediately (it parks once it's resumed).
+         * @throws std::logic_error if worker is not running or suspended when the method is called
          */
         void pause();
 
@@ -64,49 +281,309 @@ namespace worker {
         void restart();
 
         /**
-        * Stops worker (blocking call). Worker can't be restarted after it is stopped
+        * Stops worker (blocking call). Worker can't be restarted after it is stopped.
+        * Suspended worker stops once it's resumed.
         * @throws std::logic_error if worker has already finished it's work
         */
         void stop();
 
+        /**
+         * Requests worker to stop without waiting for it (non-blocking). Unlike stop it doesn't throw, so
+         * it can be used to stop many workers at once (see shutdown).
+         * @return false if worker has already finished/stopped
+         */
+        bool request_stop();
+
         /** Waits for worker to finish/stop. Thread-safe. */
         void wait() const;
 
+        /*
+         * Timed variants of the blocking calls above. They return true if the status change happened before the
+         * deadline and false on timeout. Timed out requests stay scheduled - worker still pauses/restarts/stops
+         * on it's next yield. Zero timeout can be used to only schedule the request (non-blocking).
+         * They are implemented with timed condition variable waits, so no timer threads are involved.
+         */
+
+        /** @throws std::logic_error if worker is not running or suspended when the method is called */
+        template<class Rep, class Period>
+        bool pause_for(const std::chrono::duration<Rep, Period>& timeout) {
+            return pause_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /** @throws std::logic_error if worker is not running or suspended when the method is called */
+        template<class Clock, class Duration>
+        bool pause_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+            return change_status_until(Status::PAUSED, deadline);
+        }
+
+        /** @throws std::logic_error if worker is not paused when the method is called */
+        template<class Rep, class Period>
+        bool restart_for(const std::chrono::duration<Rep, Period>& timeout) {
+            return restart_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /** @throws std::logic_error if worker is not paused when the method is called */
+        template<class Clock, class Duration>
+        bool restart_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+            return change_status_until(Status::RUNNING, deadline);
+        }
+
+        /** @throws std::logic_error if worker has already finished it's work */
+        template<class Rep, class Period>
+        bool stop_for(const std::chrono::duration<Rep, Period>& timeout) {
+            return stop_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /** @throws std::logic_error if worker has already finished it's work */
+        template<class Clock, class Duration>
+        bool stop_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+            return change_status_until(Status::STOPPED, deadline);
+        }
+
+        /** Thread-safe. */
+        template<class Rep, class Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+            return wait_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        /** Thread-safe. */
+        template<class Clock, class Duration>
+        bool wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const {
+            std::unique_lock<std::mutex> lock(status_m_);
+            return status_cv_.wait_until(lock, deadline, [this]() { return terminal_status(); });
+        }
+
     protected:
         /**
         * Must be called in a worker thread when the thread can yield control of execution.
         * Sleeps in case worker should be paused (until resumed) and checks if worker needs to stop.
         * Also used to publish worker's progress.
         * Good implementations should should call this regularly
-        * while still keeping in mind the overhead of this call (most notably the mutex lock)
+        * while still keeping in mind the overhead of this call.
+        * Fast path (no pending status change) is lock-free, mutex is only locked when worker needs to pause.
         * @param progress worker's updated progress, in the 0-1 range (0%-100%)
         * @return boolean indicating whether the worker should continue running (true) or cleanly stop (false)
         */
-        [[nodiscard]] bool yield(double progress);
+        [[nodiscard]] bool yield(double progress) {
+            set_progress(progress);
+            return check();
+        }
+
+        /**
+         * Control-only part of yield - pauses & checks for stop without publishing progress (no write to the
+         * progress that monitoring threads read).
+         * @return boolean indicating whether the worker should continue running (true) or cleanly stop (false)
+         */
+        [[nodiscard]] bool check();
 
         /**
-         * Set worker's progress. Clamped to the valid range.
+         * Set worker's progress (ignored if worker doesn't track progress). Clamped to the valid range.
+         * Progress of workers with phases is mapped to the current phase's share of the overall progress.
          * @param progress worker's updated progress, in the 0-1 range (0%-100%)
          */
-        void set_progress(double progress) { progress_ = std::clamp(progress, 0., 1.); }
+        void set_progress(double progress) {
+            if (!track_progress_) {
+                return;
+            }
+            progress = std::clamp(progress, 0., 1.);
+            if (!phases_.empty()) {
+                auto phase = this->phase();
+                progress = phase_starts_[phase] + (phase_starts_[phase + 1] - phase_starts_[phase]) * progress;
+            }
+            // unchanged progress isn't written, only changes of it's bucket count as changes (cheap fast path)
+            auto previous = progress_.load(std::memory_order_relaxed);
+            if (progress != previous) {
+                progress_ = progress;
+                if (progress_bucket(progress) != progress_bucket(previous)) {
+                    mark_change();
+                }
+            }
+        }
+
+        /**
+         * Enters phase with passed index, with 0 progress within it. Called on the worker thread.
+         * @throws std::out_of_range if worker has phases, but not one with passed index
+         */
+        void enter_phase(std::size_t index);
+
+        /** Returns true if worker has been requested to stop. Lock-free. */
+        [[nodiscard]] bool stop_requested() const noexcept {
+            return status_change_.load(std::memory_order_acquire) == Status::STOPPED;
+        }
+
+        /**
+         * Needs to be called by implementations on the thread that runs the worker, before running it.
+         * Starts measuring worker's runtime & performance counters (if enabled).
+         */
+        void worker_started() {
+            started_ = std::chrono::steady_clock::now();
+            owner_thread_ = std::this_thread::get_id();
+            begin_perf_interval();
+            has_started_.store(true, std::memory_order_release);
+        }
 
         /**
          * Needs to be called by implementations when worker is done.
          * Changes state to stopped or finished depending on the type of exit.
+         * Runtime of finished workers is reported to RuntimeModel::global() & worker-local objects are destroyed.
          */
         void worker_done();
 
+        /**
+         * Suspends worker while it's thread runs other work on top of it (e.g. preempting pooled workers).
+         * Suspended worker reports suspended status, time it's suspended for & it's performance counters aren't
+         * measured. Called on the thread running the worker, which must call resume once the other work is done.
+         * @return false if worker wasn't suspended, since it has a pending status change (pause or stop)
+         */
+        bool suspend();
+
+        /** Resumes worker suspended by suspend (it parks on it's next yield if it was paused meanwhile). */
+        void resume();
+
     private:
+        friend bool this_worker::yield(double progress);
+
+        friend void this_worker::progress(double progress);
+
+        friend bool this_worker::should_continue();
+
+        friend void this_worker::phase(std::size_t index);
+
+        friend class detail::CurrentWorkerScope;
+
+        friend bool this_worker::stop_requested() noexcept;
+
+        /** Generates next unique worker id. */
+        static worker_id_t next_id() noexcept {
+            static std::atomic<worker_id_t> id_counter = 0;
+            return ++id_counter;
+        }
+
+        /**
+         * Returns start of each phase in the overall progress, followed by 1 (end of the last phase).
+         * @throws std::invalid_argument if weights are negative or they sum to 0
+         */
+        static std::vector<double> phase_starts(const std::vector<WorkerPhase>& phases);
+
+        /** Starts measuring performance counters on the calling thread (if enabled). */
+        void begin_perf_interval() {
+            if (perf_counters_) {
+                perf_interval_ = std::make_unique<PerfCounterGroup>();
+                perf_thread_ = std::this_thread::get_id();
+            }
+        }
+
+        /**
+         * Accumulates counters of the current execution interval, if the calling thread is measuring it.
+         * Must be called under status_m_ lock.
+         * @return true if interval was ended
+         */
+        bool end_perf_interval() {
+            if (!perf_interval_ || perf_thread_ != std::this_thread::get_id()) {
+                return false;
+            }
+            perf_sample_ += perf_interval_->read();
+            perf_interval_.reset();
+            return true;
+        }
+
+        /** Marks that worker has yielded. */
+        void mark_yield() noexcept {
+            yield_count_.store(yield_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /** Returns bucket of passed progress (see change_count). */
+        static std::uint64_t progress_bucket(double progress) noexcept {
+            return static_cast<std::uint64_t>(progress * PROGRESS_BUCKETS);
+        }
+
+        /**
+         * Marks that worker's status, progress bucket or phase has changed (after the change). RMW, since helper
+         * threads (parallel utilities, OpenMP teams) also report progress - it's off the yield fast path, since
+         * progress changes only count once per bucket. Release, so readers of the count see the change.
+         */
+        void mark_change() noexcept { change_count_.fetch_add(1, std::memory_order_release); }
+
+        /**
+         * Validates & schedules status change requested by pause, restart or stop (must be called under status_m_)
+         * @throws std::logic_error if current status doesn't allow requested change
+         */
+        void schedule_status_change(Status status_change);
+
+        /** Checks whether scheduled status change happened (not thread safe) */
+        [[nodiscard]] bool status_changed(Status status_change) const {
+            // worker can always finish/stop instead, restarted worker might still be suspended
+            return status_ == status_change || terminal_status() ||
+                   (status_change == Status::RUNNING && status_ == Status::SUSPENDED);
+        }
+
+        /** Schedules status change & waits for it until deadline. Returns false on timeout. */
+        template<class Clock, class Duration>
+        bool change_status_until(Status status_change, const std::chrono::time_point<Clock, Duration>& deadline) {
+            std::unique_lock<std::mutex> lock(status_m_);
+            schedule_status_change(status_change);
+            return status_cv_.wait_until(lock, deadline, [this, status_change]() {
+                return status_changed(status_change);
+            });
+        }
+
         /** Utility for checking terminal states (not thread safe) */
         bool terminal_status() const { return status_ == Status::STOPPED || status_ == Status::FINISHED; }
 
+        const worker_id_t id_ = next_id();
         const std::string name_;
+        const std::string type_;
+        const SchedulingClass scheduling_;
+        const bool perf_counters_ = false;
+        const std::uint64_t size_ = 0;
+        const std::optional<std::chrono::steady_clock::time_point> deadline_;
+        const bool sticky_affinity_ = false;
+        const bool track_progress_ = true;
+        const std::vector<WorkerPhase> phases_;
+        const std::vector<double> phase_starts_; // see phase_starts
+        std::atomic<std::size_t> phase_ = 0; // only written by the thread running the worker
+        const labels_t labels_;
         Status status_ = Status::RUNNING;
+        std::atomic<bool> has_started_ = false; // set by worker_started
+        bool deadline_missed_ = false;
         std::atomic<double> progress_ = 0; // in percentages (0-1)
+        // incremented on every yield (and on wake from pause), without RMW since any change marks the worker alive
+        std::atomic<std::uint64_t> yield_count_ = 0;
+        // number of progress buckets (0.1% steps), progress changes within a bucket don't count as changes
+        static constexpr double PROGRESS_BUCKETS = 1000;
 
-        Status status_change_ = Status::RUNNING; // scheduled status change
+        // incremented on every change of status, progress bucket & phase, by the worker's thread or it's helpers
+        std::atomic<std::uint64_t> change_count_ = 0;
+
+        // scheduled status change, written under status_m_ but also read lock-free by yield's fast path
+        std::atomic<Status> status_change_ = Status::RUNNING;
         mutable std::mutex status_m_; // mutex for accessing worker status
         mutable std::condition_variable status_cv_; // conditional variable for changing worker status
+
+        // performance counters of the current execution interval, only accessed by the thread measuring it
+        std::unique_ptr<PerfCounterGroup> perf_interval_;
+        std::thread::id perf_thread_; // thread measured by perf_interval_
+        PerfSample perf_sample_; // accumulated over ended intervals (guarded by status_m_)
+
+        // runtime measurement
+        std::chrono::steady_clock::time_point started_; // only accessed by the thread running the worker
+        std::chrono::steady_clock::duration excluded_time_{}; // paused/suspended time (guarded by status_m_)
+        // threads parked in check (e.g. helpers of parallel algorithms) & when the first of them parked, so the
+        // pause is only excluded once, however many threads park (guarded by status_m_)
+        std::size_t n_parked_ = 0;
+        std::chrono::steady_clock::time_point parked_at_;
+        // suspension (see suspend), guarded by status_m_
+        bool suspended_ = false;
+        bool suspended_measured_ = false; // performance counters were measured when worker was suspended
+        std::chrono::steady_clock::time_point suspended_at_;
+
+        detail::LocalStorage locals_; // worker-local objects (see WorkerLocal)
+
+        // CPU affinity & migrations, only handled on the thread running the worker (not on helper threads that
+        // yield on it's behalf, e.g. parallel algorithms)
+        std::thread::id owner_thread_; // set by worker_started
+        topology::StickyAffinity affinity_;
+        std::atomic<std::uint64_t> migrations_ = 0;
     };
 
     // function type for yielding execution from worker (see BaseWorker::yield)
@@ -126,15 +603,31 @@ namespace worker {
         // infer Function return type (notice the extra yield function argument that Function must accept)
         using function_return_t = std::invoke_result_t<std::decay_t<Function>, yield_function_t, std::decay_t<Args>...>;
 
+        // enables forwarding constructors only for arguments that can initialize Function & Args
+        template<class F, class... FArgs>
+        using enable_if_constructible_t =
+                std::enable_if_t<std::is_constructible_v<std::tuple<Function, Args...>, F&&, FArgs&&...>>;
+
     public:
-        /** Constructs worker from passed function & arguments. */
-        explicit AsyncWorker(Function f, Args... args) {
-            start(std::move(f), std::move(args)...);
+        /**
+         * Constructs worker from passed function & arguments.
+         * Function & arguments are perfectly forwarded, so rvalues are moved all the way into the worker thread.
+         */
+        template<class F, class... FArgs, class = enable_if_constructible_t<F, FArgs...>>
+        explicit AsyncWorker(F&& f, FArgs&& ... args) {
+            start(std::forward<F>(f), std::forward<FArgs>(args)...);
         }
 
         /** Constructs worker from passed function & arguments and optional name for this worker. */
-        AsyncWorker(std::string name, Function f, Args... args) : BaseWorker(std::move(name)) {
-            start(std::move(f), std::move(args)...);
+        template<class F, class... FArgs, class = enable_if_constructible_t<F, FArgs...>>
+        AsyncWorker(std::string name, F&& f, FArgs&& ... args) : BaseWorker(std::move(name)) {
+            start(std::forward<F>(f), std::forward<FArgs>(args)...);
+        }
+
+        /** Constructs worker from passed function & arguments and worker options (name, scheduling class, ...). */
+        template<class F, class... FArgs, class = enable_if_constructible_t<F, FArgs...>>
+        AsyncWorker(WorkerOptions options, F&& f, FArgs&& ... args) : BaseWorker(std::move(options)) {
+            start(std::forward<F>(f), std::forward<FArgs>(args)...);
         }
 
         /**
@@ -142,6 +635,7 @@ namespace worker {
          * Note that the result might be invalid if worker was preemptively stopped (depends on worker implementation).
          * As this is wrapper for std::future::get, result can only be obtained once.
          * @throws std::future_error if future state is invalid (e.g. result already obtained)
+         * @throws any exception thrown by worker's function (e.g. WorkerStopped)
          */
         function_return_t result() {
             if (!future_.valid()) { // explicitly checked & thrown since not all implementations throw exception
@@ -151,9 +645,14 @@ namespace worker {
         }
 
     private:
-        /** Runs std::async on work method. Called by constructors. */
-        void start(Function&& f, Args&& ... args) {
-            future_ = std::async(std::launch::async, &AsyncWorker::work, this, std::move(f), std::move(args)...);
+        /**
+         * Runs std::async on work method. Called by constructors.
+         * std::async decay-copies its arguments, so forwarded rvalues are only moved (never copied) into its state.
+         */
+        template<class F, class... FArgs>
+        void start(F&& f, FArgs&& ... args) {
+            future_ = std::async(std::launch::async, &AsyncWorker::work, this,
+                                 std::forward<F>(f), std::forward<FArgs>(args)...);
         }
 
         /** Wrapper method that's run in separate thread by std::async */
@@ -162,9 +661,56 @@ namespace worker {
         std::future<function_return_t> future_;
     };
 
+    // deduces decayed function & argument types (e.g. function references decay to function pointers), only for
+    // invocable functions, so names (e.g. string literals) aren't deduced as functions
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>&, yield_function_t, std::decay_t<FArgs>...>>>
+    AsyncWorker(F&&, FArgs&& ...) -> AsyncWorker<std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>&, yield_function_t, std::decay_t<FArgs>...>>>
+    AsyncWorker(std::string, F&&, FArgs&& ...) -> AsyncWorker<std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>&, yield_function_t, std::decay_t<FArgs>...>>>
+    AsyncWorker(WorkerOptions, F&&, FArgs&& ...) -> AsyncWorker<std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    /** AsyncWorker type that make_async_worker constructs for the passed function & arguments. */
+    template<class F, class... FArgs>
+    using async_worker_t = AsyncWorker<std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    /**
+     * Constructs & starts AsyncWorker on the heap, deducing it's template arguments from passed function & arguments.
+     * Function & arguments are perfectly forwarded - rvalues (e.g. lambdas with large captures) are moved, never copied.
+     * Functions can be passed by name or by pointer.
+     */
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>, yield_function_t, std::decay_t<FArgs>...>>>
+    std::unique_ptr<async_worker_t<F, FArgs...>> make_async_worker(F&& f, FArgs&& ... args) {
+        return std::make_unique<async_worker_t<F, FArgs...>>(std::forward<F>(f), std::forward<FArgs>(args)...);
+    }
+
+    /** Same as above, but with a name for the constructed worker. */
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>, yield_function_t, std::decay_t<FArgs>...>>>
+    std::unique_ptr<async_worker_t<F, FArgs...>> make_async_worker(std::string name, F&& f, FArgs&& ... args) {
+        return std::make_unique<async_worker_t<F, FArgs...>>(std::move(name), std::forward<F>(f),
+                                                             std::forward<FArgs>(args)...);
+    }
+
+    /** Same as above, but with options (name, scheduling class, ...) for the constructed worker. */
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>, yield_function_t, std::decay_t<FArgs>...>>>
+    std::unique_ptr<async_worker_t<F, FArgs...>> make_async_worker(WorkerOptions options, F&& f, FArgs&& ... args) {
+        return std::make_unique<async_worker_t<F, FArgs...>>(std::move(options), std::forward<F>(f),
+                                                             std::forward<FArgs>(args)...);
+    }
+
     /** @throws std::domain_error if no string conversion for passed status */
     std::ostream& operator<<(std::ostream& os, Status status);
 
+    std::ostream& operator<<(std::ostream& os, const WorkerSnapshot& snapshot);
+
     std::ostream& operator<<(std::ostream& os, const BaseWorker& worker);
 
 
@@ -177,42 +723,69 @@ namespace worker {
 
     void BaseWorker::pause() {
         std::unique_lock<std::mutex> lock(status_m_);
-        if (status_ != Status::RUNNING) {
-            throw std::logic_error("Worker must be running to preform pause action");
-        }
-
-        status_change_ = Status::PAUSED;
+        schedule_status_change(Status::PAUSED);
 
         // wait for pause to happen or for worker to finish/stop
-        status_cv_.wait(lock, [this]() { return status_ == Status::PAUSED || terminal_status(); });
+        status_cv_.wait(lock, [this]() { return status_changed(Status::PAUSED); });
     }
 
     void BaseWorker::restart() {
         std::unique_lock<std::mutex> lock(status_m_);
-        if (status_ != Status::PAUSED) {
-            throw std::logic_error("Worker must be paused to preform restart action");
-        }
-
-        status_change_ = Status::RUNNING;
-        // notify sleeping worker
-        status_cv_.notify_all();
+        schedule_status_change(Status::RUNNING);
 
         // wait for restart to happen or for worker to finish/stop
-        status_cv_.wait(lock, [this]() { return status_ == Status::RUNNING || terminal_status(); });
+        status_cv_.wait(lock, [this]() { return status_changed(Status::RUNNING); });
     }
 
     void BaseWorker::stop() {
         std::unique_lock<std::mutex> lock(status_m_);
-        if (status_ != Status::RUNNING && status_ != Status::PAUSED) {
-            throw std::logic_error("Worker must be running or paused to preform stop action");
+        schedule_status_change(Status::STOPPED);
+
+        // wait for worker to stop or finish
+        status_cv_.wait(lock, [this]() { return status_changed(Status::STOPPED); });
+    }
+
+    void BaseWorker::schedule_status_change(Status status_change) {
+        switch (status_change) {
+            case Status::PAUSED:
+                if (status_ != Status::RUNNING && status_ != Status::SUSPENDED) {
+                    throw std::logic_error("Worker must be running to preform pause action");
+                }
+                break;
+            case Status::RUNNING:
+                if (status_ != Status::PAUSED) {
+                    throw std::logic_error("Worker must be paused to preform restart action");
+                }
+                break;
+            case Status::STOPPED:
+                if (status_ != Status::RUNNING && status_ != Status::PAUSED && status_ != Status::SUSPENDED) {
+                    throw std::logic_error("Worker must be running or paused to preform stop action");
+                }
+                break;
+            default:
+                throw std::logic_error("Invalid status change request");
+        }
+
+        status_change_ = status_change;
+        // suspended worker doesn't run it's own code, so it's paused/restarted without waiting for it's yield
+        if (suspended_ && status_change != Status::STOPPED) {
+            status_ = status_change == Status::PAUSED ? Status::PAUSED : Status::SUSPENDED;
+            mark_change();
+        }
+        // notify potentially sleeping worker (restart & stop)
+        status_cv_.notify_all();
+    }
+
+    bool BaseWorker::request_stop() {
+        std::lock_guard<std::mutex> lock(status_m_);
+        if (terminal_status()) {
+            return false;
         }
 
         status_change_ = Status::STOPPED;
         // notify potentially sleeping worker
         status_cv_.notify_all();
-
-        // wait for worker to stop or finish
-        status_cv_.wait(lock, [this]() { return terminal_status(); });
+        return true;
     }
 
     void BaseWorker::wait() const {
@@ -225,12 +798,80 @@ namespace worker {
         status_cv_.wait(lock, [this]() { return terminal_status(); });
     }
 
-    bool BaseWorker::yield(double progress) {
-        set_progress(progress);
+    WorkerSnapshot BaseWorker::snapshot() const {
+        WorkerSnapshot snapshot;
+        snapshot.id = id_;
+        snapshot.name = name_;
+        snapshot.status = status();
+        snapshot.progress = progress();
+        if (!phases_.empty()) {
+            snapshot.phase = phases_[phase()].name;
+        }
+        return snapshot;
+    }
+
+    void BaseWorker::enter_phase(std::size_t index) {
+        if (phases_.empty()) {
+            return;
+        }
+        if (index >= phases_.size()) {
+            throw std::out_of_range("Worker doesn't have phase " + std::to_string(index));
+        }
+        phase_.store(index, std::memory_order_relaxed);
+        mark_change();
+        set_progress(0);
+    }
+
+    std::vector<double> BaseWorker::phase_starts(const std::vector<WorkerPhase>& phases) {
+        double total_weight = 0;
+        for (const auto& phase: phases) {
+            if (phase.weight < 0) {
+                throw std::invalid_argument("Phase weights must be non-negative");
+            }
+            total_weight += phase.weight;
+        }
+        if (phases.empty()) {
+            return {};
+        }
+        if (total_weight <= 0) {
+            throw std::invalid_argument("Phase weights must sum to a positive number");
+        }
+
+        std::vector<double> starts{0};
+        for (const auto& phase: phases) {
+            starts.push_back(starts.back() + phase.weight / total_weight);
+        }
+        starts.back() = 1; // no rounding errors at the end
+        return starts;
+    }
+
+    bool BaseWorker::check() {
+        mark_yield();
+
+        // fast path - no status change was requested
+        auto status_change = status_change_.load(std::memory_order_acquire);
+        if (status_change == Status::RUNNING) {
+            return true;
+        }
+        if (status_change == Status::STOPPED) {
+            return false;
+        }
 
         std::unique_lock<std::mutex> lock(status_m_);
         if (status_change_ == Status::PAUSED) {
+            // paused time isn't measured (worker might also resume on a different thread)
+            bool measured = end_perf_interval();
+            if (n_parked_++ == 0) {
+                parked_at_ = std::chrono::steady_clock::now();
+            }
+            bool owner = std::this_thread::get_id() == owner_thread_;
+            auto paused_cpu = topology::current_cpu();
+            if (owner && sticky_affinity_) {
+                affinity_.leave();
+            }
+
             status_ = Status::PAUSED;
+            mark_change();
             // notify of the status change
             status_cv_.notify_all();
             // sleep until restart or stop is requested
@@ -239,6 +880,21 @@ namespace worker {
             });
 
             status_ = Status::RUNNING;
+            mark_change();
+            // time from the first parked thread to the last woken one is excluded
+            if (--n_parked_ == 0) {
+                excluded_time_ += std::chrono::steady_clock::now() - parked_at_;
+            }
+            if (owner && sticky_affinity_) {
+                affinity_.resume();
+            }
+            if (owner && topology::current_cpu() != paused_cpu) {
+                migrations_.fetch_add(1, std::memory_order_relaxed);
+            }
+            mark_yield(); // time spent paused doesn't count as a stall
+            if (measured) {
+                begin_perf_interval();
+            }
             // notify of the wake
             status_cv_.notify_all();
         }
@@ -250,14 +906,61 @@ namespace worker {
         return true;
     }
 
+    bool BaseWorker::suspend() {
+        std::lock_guard<std::mutex> lock(status_m_);
+        if (status_change_ != Status::RUNNING) {
+            return false;
+        }
+
+        suspended_ = true;
+        // work that runs on top of the worker isn't measured as worker's
+        suspended_measured_ = end_perf_interval();
+        suspended_at_ = std::chrono::steady_clock::now();
+        status_ = Status::SUSPENDED;
+        mark_change();
+        // notify of the status change
+        status_cv_.notify_all();
+        return true;
+    }
+
+    void BaseWorker::resume() {
+        std::lock_guard<std::mutex> lock(status_m_);
+        suspended_ = false;
+        excluded_time_ += std::chrono::steady_clock::now() - suspended_at_;
+        if (suspended_measured_) {
+            begin_perf_interval();
+        }
+        // worker that was paused while suspended stays paused & parks on it's next yield
+        if (status_change_ != Status::PAUSED) {
+            status_ = Status::RUNNING;
+            mark_change();
+        }
+        mark_yield(); // time spent suspended doesn't count as a stall
+        // notify of the status change
+        status_cv_.notify_all();
+    }
+
     void BaseWorker::worker_done() {
+        // worker-local objects are destroyed before the worker is done (& outside of the lock)
+        locals_.clear();
+
         std::lock_guard<std::mutex> lock(status_m_);
         // worker could've finished or was stopped
         status_ = status_change_ != Status::STOPPED ? Status::FINISHED : Status::STOPPED;
 
-        // force 100% progress if worker finished
+        // force 100% progress & report runtime if worker finished (stopped workers' runtimes are partial)
         if (status_ == Status::FINISHED) {
-            set_progress(1);
+            auto now = std::chrono::steady_clock::now();
+            progress_ = 1;
+            RuntimeModel::global().add(type(), size_, now - started_ - excluded_time_);
+            deadline_missed_ = deadline_ && now > *deadline_;
+        }
+        mark_change();
+        // worker doesn't claim it's CPU anymore (e.g. pool thread runs other workers)
+        affinity_.release();
+        // counters are reported under worker's type
+        if (end_perf_interval()) {
+            PerfStats::global().add(type(), perf_sample_);
         }
         // notify of the status change
         status_cv_.notify_all();
@@ -266,22 +969,73 @@ namespace worker {
     template<class Function, class... Args>
     typename AsyncWorker<Function, Args...>::function_return_t
     AsyncWorker<Function, Args...>::work(Function&& f, Args&& ... args) {
+        // makes worker available through this_worker functions
+        detail::CurrentWorkerScope worker_scope(this);
+        // runs with worker's scheduling class (std::async thread isn't shared, so irreversible demotions are applied)
+        ScopedScheduling scheduling_scope(scheduling(), false);
+        worker_started();
+
         // yield function that's to be passed to worker function
         auto yield_func = std::bind(&AsyncWorker::yield, this, std::placeholders::_1);
 
-        // void return type needs to be handled separately
-        if constexpr(std::is_same_v<function_return_t, void>) {
-            f(yield_func, std::move(args)...);
-            worker_done();
-            return;
+        try {
+            // void return type needs to be handled separately
+            if constexpr(std::is_same_v<function_return_t, void>) {
+                f(yield_func, std::move(args)...);
+                worker_done();
+                return;
+            }
+            else {
+                function_return_t ret = f(yield_func, std::move(args)...);
+                worker_done();
+                return ret;
+            }
         }
-        else {
-            function_return_t ret = f(yield_func, std::move(args)...);
+        catch (...) {
+            // worker is done even if it exited with exception (e.g. WorkerStopped), exception is stored in the future
             worker_done();
-            return ret;
+            throw;
         }
     }
 
+    detail::CurrentWorkerScope::CurrentWorkerScope(BaseWorker* worker) noexcept:
+            previous_(current_worker), previous_storage_(current_local_storage) {
+        current_worker = worker;
+        current_local_storage = worker != nullptr ? &worker->locals_ : nullptr;
+    }
+
+    bool this_worker::yield(double progress) {
+        auto* worker = detail::current_worker;
+        return worker == nullptr || worker->yield(progress);
+    }
+
+    void this_worker::progress(double progress) {
+        if (auto* worker = detail::current_worker) {
+            worker->set_progress(progress);
+        }
+    }
+
+    bool this_worker::should_continue() {
+        auto* worker = detail::current_worker;
+        return worker == nullptr || worker->check();
+    }
+
+    void this_worker::phase(std::size_t index) {
+        if (auto* worker = detail::current_worker) {
+            worker->enter_phase(index);
+        }
+    }
+
+    bool this_worker::stop_requested() noexcept {
+        auto* worker = detail::current_worker;
+        return worker != nullptr && worker->stop_requested();
+    }
+
+    worker_id_t this_worker::id() noexcept {
+        auto* worker = detail::current_worker;
+        return worker != nullptr ? worker->id() : 0;
+    }
+
     std::ostream& operator<<(std::ostream& os, Status status) {
         switch (status) {
             case Status::RUNNING:
@@ -292,19 +1046,30 @@ namespace worker {
                 return os << "stopped";
             case Status::FINISHED:
                 return os << "finished";
+            case Status::SUSPENDED:
+                return os << "suspended";
         }
 
         throw std::domain_error("status does not have string conversion");
     }
 
-    std::ostream& operator<<(std::ostream& os, const BaseWorker& worker) {
-        auto worker_status = worker.status();
-        os << "worker " << std::setw(20) << worker.name() << " - " << std::setw(10) << worker_status;
+    std::ostream& operator<<(std::ostream& os, const WorkerSnapshot& snapshot) {
+        os << "worker " << std::setw(20) << snapshot.name << " - " << std::setw(10) << snapshot.status;
 
-        if ((worker_status == Status::RUNNING || worker_status == Status::PAUSED) && worker.progress() > 0) {
-            os << " (" << std::setw(3) << std::round(worker.progress() * 100) << "% done)";
+        if (snapshot.status == Status::RUNNING || snapshot.status == Status::PAUSED ||
+            snapshot.status == Status::SUSPENDED) {
+            if (snapshot.progress > 0) {
+                os << " (" << std::setw(3) << std::round(snapshot.progress * 100) << "% done)";
+            }
+            if (!snapshot.phase.empty()) {
+                os << " [" << snapshot.phase << "]";
+            }
         }
         return os;
     }
+
+    std::ostream& operator<<(std::ostream& os, const BaseWorker& worker) {
+        return os << worker.snapshot();
+    }
 }
 #endif //WORKERS_MANAGER_WORKER_HPP
\ No newline at end of file
@@ -0,0 +1,522 @@
+/** Pool backend for workers: a fixed number of threads running workers, ordered by a pluggable scheduler. */
+
+#ifndef WORKERS_MANAGER_WORKER_POOL_HPP
+#define WORKERS_MANAGER_WORKER_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <worker/worker.hpp>
+#include <worker/thread_pool.hpp>
+#include <worker/topology.hpp>
+
+namespace worker {
+    class WorkerPool;
+
+    /** Thrown by WorkerPool::submit when pool doesn't accept the worker (e.g. it can't meet worker's deadline). */
+    class WorkerRejected : public std::runtime_error {
+    public:
+        explicit WorkerRejected(const std::string& reason) : std::runtime_error("worker has been rejected: " + reason) {}
+    };
+
+    /** Pool thread that's picking a worker to run. */
+    struct PoolSlot {
+        std::size_t thread; // index of the pool thread
+        int socket; // socket the pool thread belongs to
+    };
+
+    /**
+     * Abstract base class for workers that are run by a WorkerPool instead of their own thread.
+     * Queued workers report running status, but they haven't started (see BaseWorker::started) - pause/stop requests
+     * take effect once they start (a worker that was stopped while queued isn't run at all).
+     * Paused workers keep occupying their pool thread.
+     * Yields through worker's yield function are also preemption points (see PoolScheduler::preempt), where
+     * the worker can be suspended (see BaseWorker::suspend) until the preempting workers are done.
+     */
+    class PooledWorkerBase : public BaseWorker {
+    public:
+        using BaseWorker::BaseWorker;
+
+    protected:
+        /** Runs the worker on the calling (pool) thread. Called once by the pool. */
+        virtual void run() = 0;
+
+        /**
+         * Stops worker that won't be run (e.g. rejected or dropped), without running it on the calling thread.
+         * Only settles it's state & result, so it can be waited on & safely destroyed. Called at most once instead of run.
+         */
+        virtual void discard() = 0;
+
+        /** Same as BaseWorker::yield, but it's also a preemption point. */
+        [[nodiscard]] bool pool_yield(double progress);
+
+    private:
+        friend class WorkerPool;
+
+        WorkerPool* pool_ = nullptr; // pool running the worker
+        PoolSlot slot_{}; // slot the worker runs on
+        std::uint64_t n_submitted_ = 0; // pool submissions seen at the last preemption point
+        bool nested_ = false; // preempted another worker, so it isn't preempted itself
+    };
+
+    /**
+     * Decides which of the queued workers runs next. Pool calls all the methods under it's lock,
+     * so implementations don't need to be thread-safe.
+     */
+    class PoolScheduler {
+    public:
+        virtual ~PoolScheduler() = default;
+
+        /** Called by the pool with all of it's slots, before any other method. */
+        virtual void init(const std::vector<PoolSlot>& slots) { (void) slots; }
+
+        /** Returns false if submitted worker shouldn't be queued (admission control, see WorkerRejected). */
+        virtual bool admit(const PooledWorkerBase& worker) {
+            (void) worker;
+            return true;
+        }
+
+        /** Queues submitted worker. */
+        virtual void push(std::shared_ptr<PooledWorkerBase> worker) = 0;
+
+        /**
+         * Returns the next worker to run on passed slot, nullptr if no worker should run there right now.
+         * Must return a worker if there are queued workers and no workers are running (so the pool can't stall).
+         */
+        virtual std::shared_ptr<PooledWorkerBase> pop(const PoolSlot& slot) = 0;
+
+        /**
+         * Returns true if a queued worker (the one popped next) should preempt the worker running on passed slot.
+         * Called at running worker's preemption points, only after new workers were submitted.
+         * Preempting worker runs nested on the same thread, running worker is suspended until it's done.
+         * Preempting workers & stopped workers aren't preempted. Workers are never preempted by default.
+         */
+        virtual bool preempt(const PooledWorkerBase& running, const PoolSlot& slot) {
+            (void) running;
+            (void) slot;
+            return false;
+        }
+
+        /** Called when worker that was popped for passed slot is done. */
+        virtual void done(const PooledWorkerBase& worker, const PoolSlot& slot) {
+            (void) worker;
+            (void) slot;
+        }
+
+        /**
+         * Removes & returns the earliest submitted queued worker (see OverflowPolicy::DROP_OLDEST).
+         * Schedulers that don't support it return nullptr.
+         */
+        virtual std::shared_ptr<PooledWorkerBase> drop_oldest() { return nullptr; }
+
+        /** Returns true if there are no queued workers. */
+        [[nodiscard]] virtual bool empty() const = 0;
+    };
+
+    /** Runs workers in submission order. */
+    class FifoScheduler : public PoolScheduler {
+    public:
+        void push(std::shared_ptr<PooledWorkerBase> worker) override { queue_.push_back(std::move(worker)); }
+
+        std::shared_ptr<PooledWorkerBase> pop(const PoolSlot&) override {
+            if (queue_.empty()) {
+                return nullptr;
+            }
+            auto worker = std::move(queue_.front());
+            queue_.pop_front();
+            return worker;
+        }
+
+        std::shared_ptr<PooledWorkerBase> drop_oldest() override { return pop({}); }
+
+        [[nodiscard]] bool empty() const override { return queue_.empty(); }
+
+    private:
+        std::deque<std::shared_ptr<PooledWorkerBase>> queue_;
+    };
+
+    /** What pool does with submitted worker when it's queue is full. */
+    enum class OverflowPolicy {
+        BLOCK, // submit blocks until there's space in the queue
+        REJECT, // submit throws WorkerRejected
+        CALLER_RUNS, // worker runs on the submitting thread (submit returns once it's done)
+        DROP_OLDEST // the earliest submitted queued worker is stopped to make space (rejects if unsupported)
+    };
+
+    /** WorkerPool configuration. */
+    struct PoolOptions {
+        std::size_t n_threads = ThreadPool::default_size(); // number of pool threads (at least 1)
+        bool pin_to_sockets = false; // pins pool threads to the CPUs of the socket they are assigned to
+        std::size_t queue_capacity = 0; // maximum number of queued workers, 0 for unbounded queue
+        OverflowPolicy overflow = OverflowPolicy::BLOCK; // applied when queue is full
+    };
+
+    /**
+     * Fixed number of threads that run submitted workers in the order decided by the scheduler.
+     * Pool threads are assigned to sockets round-robin (and optionally pinned to them).
+     * Queue can be bounded, in which case overflow policy is applied to workers submitted when it's full.
+     * Destructor waits for all submitted workers to be done.
+     */
+    class WorkerPool {
+    public:
+        /**
+         * @param n_threads number of pool threads (at least 1)
+         * @param scheduler decides the order of queued workers (FIFO by default)
+         * @param pin_to_sockets pins pool threads to the CPUs of the socket they are assigned to
+         */
+        explicit WorkerPool(std::size_t n_threads = ThreadPool::default_size(),
+                            std::unique_ptr<PoolScheduler> scheduler = std::make_unique<FifoScheduler>(),
+                            bool pin_to_sockets = false) :
+                WorkerPool(PoolOptions{n_threads, pin_to_sockets}, std::move(scheduler)) {}
+
+        /**
+         * @param options pool configuration (number of threads, queue capacity, ...)
+         * @param scheduler decides the order of queued workers (FIFO by default)
+         */
+        explicit WorkerPool(const PoolOptions& options,
+                            std::unique_ptr<PoolScheduler> scheduler = std::make_unique<FifoScheduler>()) :
+                scheduler_(std::move(scheduler)), queue_capacity_(options.queue_capacity),
+                overflow_(options.overflow) {
+            auto sockets = topology::sockets();
+            std::vector<PoolSlot> slots;
+            for (std::size_t i = 0; i < std::max<std::size_t>(options.n_threads, 1); ++i) {
+                slots.push_back({i, sockets[i % sockets.size()]});
+            }
+            scheduler_->init(slots);
+
+            threads_.reserve(slots.size());
+            for (const auto& slot: slots) {
+                threads_.emplace_back(&WorkerPool::thread_loop, this, slot, options.pin_to_sockets);
+            }
+        }
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(pool_m_);
+                stop_ = true;
+            }
+            pool_cv_.notify_all();
+
+            for (auto& thread: threads_) {
+                thread.join();
+            }
+        }
+
+        // non-copyable
+        WorkerPool(const WorkerPool& other) = delete;
+
+        WorkerPool& operator=(const WorkerPool& other) = delete;
+
+        /**
+         * Queues worker to be run by the pool. Pool keeps the worker alive until it's done. Thread-safe.
+         * If the queue is full, overflow policy is applied (blocking policy shouldn't be used when submitting
+         * from pool's workers, since they could block all pool threads).
+         * @throws WorkerRejected if scheduler doesn't admit the worker or if the queue is full with rejecting policy
+         * (worker is stopped without running)
+         */
+        void submit(std::shared_ptr<PooledWorkerBase> worker) {
+            std::unique_lock<std::mutex> lock(pool_m_);
+            if (!scheduler_->admit(*worker)) {
+                lock.unlock();
+                worker->discard();
+                throw WorkerRejected("scheduler didn't admit it");
+            }
+
+            std::shared_ptr<PooledWorkerBase> dropped;
+            if (queue_full()) {
+                switch (overflow_) {
+                    case OverflowPolicy::BLOCK:
+                        queue_cv_.wait(lock, [this]() { return !queue_full(); });
+                        break;
+                    case OverflowPolicy::CALLER_RUNS:
+                        lock.unlock();
+                        worker->run();
+                        return;
+                    case OverflowPolicy::DROP_OLDEST:
+                        dropped = scheduler_->drop_oldest();
+                        if (dropped) {
+                            --n_queued_;
+                            break;
+                        }
+                        [[fallthrough]];
+                    case OverflowPolicy::REJECT:
+                        lock.unlock();
+                        worker->discard();
+                        throw WorkerRejected("queue is full");
+                }
+            }
+
+            scheduler_->push(std::move(worker));
+            ++n_queued_;
+            n_submitted_.fetch_add(1, std::memory_order_release);
+            lock.unlock();
+
+            // schedulers might not allow every thread to run every worker, so all threads are woken
+            pool_cv_.notify_all();
+            if (dropped) {
+                dropped->discard();
+            }
+        }
+
+        /** Returns number of pool threads */
+        [[nodiscard]] std::size_t size() const noexcept { return threads_.size(); }
+
+        /** Returns number of queued workers. Thread-safe. */
+        [[nodiscard]] std::size_t n_queued() const {
+            std::lock_guard<std::mutex> lock(pool_m_);
+            return n_queued_;
+        }
+
+        /** Returns number of workers that are currently run by the pool (including suspended ones). Thread-safe. */
+        [[nodiscard]] std::size_t n_running() const {
+            std::lock_guard<std::mutex> lock(pool_m_);
+            return n_running_;
+        }
+
+    private:
+        friend class PooledWorkerBase;
+
+        /** Main loop of a pool thread. Runs workers until the pool is destroyed and there are no queued workers. */
+        void thread_loop(PoolSlot slot, bool pin_to_socket) {
+            if (pin_to_socket) {
+                topology::pin_to_socket(slot.socket);
+            }
+
+            std::unique_lock<std::mutex> lock(pool_m_);
+            while (true) {
+                auto worker = scheduler_->pop(slot);
+                if (!worker) {
+                    if (stop_ && scheduler_->empty()) {
+                        return;
+                    }
+                    pool_cv_.wait(lock);
+                    continue;
+                }
+
+                run_worker(lock, std::move(worker), slot);
+            }
+        }
+
+        /** Returns true if the queue is bounded & full (must be called under pool_m_). */
+        [[nodiscard]] bool queue_full() const { return queue_capacity_ > 0 && n_queued_ >= queue_capacity_; }
+
+        /**
+         * Runs popped worker on passed slot. Lock is released while the worker runs.
+         * @param nested whether worker preempts another one on the same thread
+         */
+        void run_worker(std::unique_lock<std::mutex>& lock, std::shared_ptr<PooledWorkerBase> worker,
+                        const PoolSlot& slot, bool nested = false) {
+            // popped worker makes space in the queue
+            --n_queued_;
+            queue_cv_.notify_all();
+
+            ++n_running_;
+            worker->pool_ = this;
+            worker->slot_ = slot;
+            worker->n_submitted_ = n_submitted_.load(std::memory_order_relaxed);
+            worker->nested_ = nested;
+
+            lock.unlock();
+            worker->run();
+            lock.lock();
+
+            --n_running_;
+            scheduler_->done(*worker, slot);
+            // finished worker might allow other threads to run queued workers (or exit)
+            pool_cv_.notify_all();
+        }
+
+        /**
+         * Runs queued workers that preempt the running worker on it's thread (see PoolScheduler::preempt),
+         * running worker is suspended meanwhile. Lock-free unless workers were submitted since worker's last
+         * preemption point.
+         */
+        void preemption_point(PooledWorkerBase& running) {
+            // preempting workers aren't preempted themselves, so a thread's stack holds at most two workers
+            if (running.nested_) {
+                return;
+            }
+            auto n_submitted = n_submitted_.load(std::memory_order_acquire);
+            if (n_submitted == running.n_submitted_) {
+                return;
+            }
+            running.n_submitted_ = n_submitted;
+
+            bool suspended = false;
+            std::unique_lock<std::mutex> lock(pool_m_);
+            // stopped worker isn't preempted anymore, so it stops once the current preempting worker is done
+            while (!running.stop_requested() && scheduler_->preempt(running, running.slot_)) {
+                // worker with a pending pause/stop handles it first
+                if (!suspended && !running.suspend()) {
+                    break;
+                }
+                suspended = true;
+
+                auto worker = scheduler_->pop(running.slot_);
+                if (!worker) {
+                    break;
+                }
+                run_worker(lock, std::move(worker), running.slot_, true);
+            }
+            lock.unlock();
+
+            if (suspended) {
+                running.resume();
+            }
+        }
+
+        std::vector<std::thread> threads_;
+
+        std::unique_ptr<PoolScheduler> scheduler_; // guarded by pool_m_
+        const std::size_t queue_capacity_;
+        const OverflowPolicy overflow_;
+        std::size_t n_queued_ = 0;
+        std::size_t n_running_ = 0;
+        std::atomic<std::uint64_t> n_submitted_ = 0; // incremented on every submit (written under pool_m_)
+        bool stop_ = false; // set on destruction
+        mutable std::mutex pool_m_; // mutex for accessing scheduler & pool state
+        std::condition_variable pool_cv_; // conditional variable for notifying pool threads of changes
+        std::condition_variable queue_cv_; // conditional variable for notifying blocked submitters of queue space
+    };
+
+    /**
+     * Worker that's run by a WorkerPool and returns result (see AsyncWorker).
+     * Constructed & submitted with make_pooled_worker.
+     */
+    template<class Function, class... Args>
+    class PooledWorker final : public PooledWorkerBase {
+        using function_return_t = std::invoke_result_t<std::decay_t<Function>, yield_function_t, std::decay_t<Args>...>;
+
+    public:
+        /** Constructs (but doesn't submit) worker from passed options, function & arguments. */
+        template<class F, class... FArgs,
+                class = std::enable_if_t<std::is_constructible_v<std::tuple<Function, Args...>, F&&, FArgs&&...>>>
+        PooledWorker(WorkerOptions options, F&& f, FArgs&& ... args) :
+                PooledWorkerBase(std::move(options)),
+                task_(std::in_place, std::forward<F>(f), std::forward<FArgs>(args)...) {}
+
+        /**
+         * Returns worker's result. Blocks until the result is available (worker finished or stopped).
+         * Result can only be obtained once.
+         * @throws std::future_error if future state is invalid (e.g. result already obtained)
+         * @throws any exception thrown by worker's function (WorkerStopped if stopped before it started)
+         */
+        function_return_t result() {
+            if (!future_.valid()) {
+                throw std::future_error(std::future_errc::no_state);
+            }
+            return future_.get();
+        }
+
+    private:
+        void run() override;
+
+        void discard() override;
+
+        // destroyed once worker is done, also if it never ran (e.g. captured resources are released)
+        std::optional<std::tuple<Function, Args...>> task_;
+        std::promise<function_return_t> promise_;
+        std::future<function_return_t> future_ = promise_.get_future();
+    };
+
+    /** PooledWorker type that make_pooled_worker constructs for the passed function & arguments. */
+    template<class F, class... FArgs>
+    using pooled_worker_t = PooledWorker<std::decay_t<F>, std::decay_t<FArgs>...>;
+
+    /**
+     * Constructs worker & submits it to the pool. Function & arguments are perfectly forwarded (see make_async_worker).
+     * @param options worker options (name, scheduling class, ...)
+     * @throws WorkerRejected if pool doesn't accept the worker
+     */
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>, yield_function_t, std::decay_t<FArgs>...>>>
+    std::shared_ptr<pooled_worker_t<F, FArgs...>> make_pooled_worker(WorkerPool& pool, WorkerOptions options,
+                                                                     F&& f, FArgs&& ... args) {
+        auto worker = std::make_shared<pooled_worker_t<F, FArgs...>>(std::move(options), std::forward<F>(f),
+                                                                     std::forward<FArgs>(args)...);
+        pool.submit(worker);
+        return worker;
+    }
+
+    /** Same as above, without worker options. */
+    template<class F, class... FArgs,
+            class = std::enable_if_t<std::is_invocable_v<std::decay_t<F>, yield_function_t, std::decay_t<FArgs>...>>>
+    std::shared_ptr<pooled_worker_t<F, FArgs...>> make_pooled_worker(WorkerPool& pool, F&& f, FArgs&& ... args) {
+        return make_pooled_worker(pool, WorkerOptions(), std::forward<F>(f), std::forward<FArgs>(args)...);
+    }
+
+
+    // ******* Implementations ********************************************
+    inline bool PooledWorkerBase::pool_yield(double progress) {
+        // schedulers might need up to date progress of the running worker
+        set_progress(progress);
+        if (pool_ != nullptr) {
+            pool_->preemption_point(*this);
+        }
+        return check();
+    }
+
+    template<class Function, class... Args>
+    void PooledWorker<Function, Args...>::run() {
+        // makes worker available through this_worker functions
+        detail::CurrentWorkerScope worker_scope(this);
+        // runs with worker's scheduling class (restores pool thread's scheduling on exit)
+        ScopedScheduling scheduling_scope(scheduling());
+        worker_started();
+
+        // yield function that's to be passed to worker function
+        auto yield_func = std::bind(&PooledWorker::pool_yield, this, std::placeholders::_1);
+        auto invoke = [&yield_func](Function& f, Args& ... args) -> function_return_t {
+            return f(yield_func, std::move(args)...);
+        };
+
+        try {
+            if (stop_requested()) { // stopped while queued
+                throw WorkerStopped();
+            }
+
+            // void return type needs to be handled separately
+            if constexpr(std::is_same_v<function_return_t, void>) {
+                std::apply(invoke, *task_);
+                task_.reset();
+                worker_done();
+                promise_.set_value();
+            }
+            else {
+                function_return_t ret = std::apply(invoke, *task_);
+                task_.reset();
+                worker_done();
+                promise_.set_value(std::move(ret));
+            }
+        }
+        catch (...) {
+            task_.reset();
+            worker_done();
+            promise_.set_exception(std::current_exception());
+        }
+    }
+
+    template<class Function, class... Args>
+    void PooledWorker<Function, Args...>::discard() {
+        // worker isn't started (no scheduling class, performance counters, ...), it's only settled as stopped
+        request_stop();
+        task_.reset();
+        worker_done();
+        promise_.set_exception(std::make_exception_ptr(WorkerStopped()));
+    }
+}
+
+#endif //WORKERS_MANAGER_WORKER_POOL_HPP
@@ -0,0 +1,179 @@
+/** Iterator & range adapters that make unmodified standard algorithms pausable and stoppable. */
+
+#ifndef WORKERS_MANAGER_YIELD_ITERATOR_HPP
+#define WORKERS_MANAGER_YIELD_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include <worker/worker.hpp>
+
+namespace worker {
+    // default number of traversed elements between two yields
+    constexpr std::ptrdiff_t DEFAULT_YIELD_EVERY = 1024;
+
+    /**
+     * Iterator adapter that counts traversed elements and yields execution (see this_worker::yield)
+     * every yield_every steps. Progress is published as iterator's position in the adapted range.
+     * Stop is surfaced by throwing WorkerStopped, so algorithms are exited early without being modified.
+     * Outside of a worker the adapter behaves as the underlying iterator.
+     * @tparam Iterator underlying iterator type (at least forward iterator)
+     */
+    template<class Iterator>
+    class YieldIterator {
+        using traits = std::iterator_traits<Iterator>;
+
+        static_assert(std::is_base_of_v<std::forward_iterator_tag, typename traits::iterator_category>,
+                      "YieldIterator requires at least a forward iterator");
+
+    public:
+        using iterator_category = typename traits::iterator_category;
+        using value_type = typename traits::value_type;
+        using difference_type = typename traits::difference_type;
+        using pointer = typename traits::pointer;
+        using reference = typename traits::reference;
+
+        YieldIterator() = default;
+
+        /**
+         * @param it underlying iterator
+         * @param position it's position in the adapted range (used for progress)
+         * @param size size of the adapted range
+         * @param yield_every number of traversed elements between two yields
+         */
+        YieldIterator(Iterator it, difference_type position, difference_type size, difference_type yield_every) :
+                it_(std::move(it)), position_(position), size_(size), yield_every_(yield_every),
+                countdown_(yield_every) {}
+
+        /** Returns underlying iterator */
+        [[nodiscard]] const Iterator& base() const noexcept { return it_; }
+
+        reference operator*() const { return *it_; }
+
+        Iterator operator->() const { return it_; }
+
+        reference operator[](difference_type n) const { return it_[n]; }
+
+        YieldIterator& operator++() {
+            ++it_;
+            advance_position(1);
+            return *this;
+        }
+
+        YieldIterator operator++(int) {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        YieldIterator& operator--() {
+            --it_;
+            advance_position(-1);
+            return *this;
+        }
+
+        YieldIterator operator--(int) {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        YieldIterator& operator+=(difference_type n) {
+            it_ += n;
+            advance_position(n);
+            return *this;
+        }
+
+        YieldIterator& operator-=(difference_type n) { return *this += -n; }
+
+        friend YieldIterator operator+(YieldIterator it, difference_type n) { return it += n; }
+
+        friend YieldIterator operator+(difference_type n, YieldIterator it) { return it += n; }
+
+        friend YieldIterator operator-(YieldIterator it, difference_type n) { return it -= n; }
+
+        friend difference_type operator-(const YieldIterator& lhs, const YieldIterator& rhs) {
+            return lhs.it_ - rhs.it_;
+        }
+
+        friend bool operator==(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ == rhs.it_; }
+
+        friend bool operator!=(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ != rhs.it_; }
+
+        friend bool operator<(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ < rhs.it_; }
+
+        friend bool operator>(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ > rhs.it_; }
+
+        friend bool operator<=(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ <= rhs.it_; }
+
+        friend bool operator>=(const YieldIterator& lhs, const YieldIterator& rhs) { return lhs.it_ >= rhs.it_; }
+
+    private:
+        /**
+         * Moves position by n elements and yields if enough elements were traversed since the last yield.
+         * @throws WorkerStopped if worker should stop
+         */
+        void advance_position(difference_type n) {
+            position_ += n;
+            countdown_ -= n < 0 ? -n : n;
+            if (countdown_ > 0) {
+                return;
+            }
+
+            countdown_ = yield_every_;
+            auto progress = size_ > 0 ? static_cast<double>(position_) / static_cast<double>(size_) : 0.;
+            if (!this_worker::yield(progress)) {
+                throw WorkerStopped();
+            }
+        }
+
+        Iterator it_{};
+        difference_type position_ = 0;
+        difference_type size_ = 0;
+        difference_type yield_every_ = DEFAULT_YIELD_EVERY;
+        difference_type countdown_ = DEFAULT_YIELD_EVERY; // number of steps left until the next yield
+    };
+
+    /** Range of YieldIterators, usable with standard algorithms & range-based for loops. */
+    template<class Iterator>
+    class YieldRange {
+    public:
+        using iterator = YieldIterator<Iterator>;
+        using difference_type = typename iterator::difference_type;
+
+        YieldRange(Iterator first, Iterator last, difference_type yield_every) :
+                size_(std::distance(first, last)),
+                first_(std::move(first), 0, size_, yield_every),
+                last_(std::move(last), size_, size_, yield_every) {}
+
+        [[nodiscard]] iterator begin() const { return first_; }
+
+        [[nodiscard]] iterator end() const { return last_; }
+
+        [[nodiscard]] difference_type size() const noexcept { return size_; }
+
+    private:
+        difference_type size_;
+        iterator first_;
+        iterator last_;
+    };
+
+    /**
+     * Adapts [first, last) range so that algorithms traversing it yield every yield_every elements.
+     * Example: std::accumulate(range.begin(), range.end(), 0) with range = yield_range(vec.begin(), vec.end())
+     * @throws WorkerStopped from adapted iterators (not this function) if worker is stopped during traversal
+     */
+    template<class Iterator>
+    YieldRange<Iterator> yield_range(Iterator first, Iterator last, std::ptrdiff_t yield_every = DEFAULT_YIELD_EVERY) {
+        return YieldRange<Iterator>(std::move(first), std::move(last), yield_every);
+    }
+
+    /** Same as above, for the whole container/range. */
+    template<class Range>
+    auto yield_range(Range& range, std::ptrdiff_t yield_every = DEFAULT_YIELD_EVERY) {
+        return yield_range(std::begin(range), std::end(range), yield_every);
+    }
+}
+
+#endif //WORKERS_MANAGER_YIELD_ITERATOR_HPP